@@ -9,10 +9,30 @@ if("${CPACK_GTIRB_FUNCTIONS_PACKAGE}" STREQUAL "dev")
   set(CPACK_PACKAGE_FILE_NAME "libgtirb-functions-dev")
   set(CPACK_COMPONENTS_ALL headers cmake_config cmake_target)
   set(CPACK_DEBIAN_PACKAGE_DEPENDS
-      "libgtirb-dev (=${CPACK_GTIRB_VERSION}-${CPACK_UBUNTU_NAME})")
+      "libgtirb-dev (=${CPACK_GTIRB_VERSION}-${CPACK_UBUNTU_NAME}), libgtirb-functions (=${CPACK_GTIRB_FUNCTIONS_VERSION}-${CPACK_UBUNTU_NAME})"
+  )
 
   set(CPACK_RPM_PACKAGE_NAME "libgtirb-functions-devel")
   set(CPACK_RPM_FILE_NAME "${CPACK_RPM_PACKAGE_NAME}.rpm")
-  set(CPACK_RPM_PACKAGE_REQUIRES "libgtirb-devel = ${CPACK_GTIRB_VERSION}")
+  set(CPACK_RPM_PACKAGE_REQUIRES
+      "libgtirb-devel = ${CPACK_GTIRB_VERSION}, libgtirb-functions = ${CPACK_GTIRB_FUNCTIONS_VERSION}"
+  )
+
+elseif("${CPACK_GTIRB_FUNCTIONS_PACKAGE}" STREQUAL "lib")
+  set(CPACK_PACKAGE_NAME "libgtirb-functions")
+  set(CPACK_PACKAGE_FILE_NAME "libgtirb-functions")
+  set(CPACK_COMPONENTS_ALL library)
+
+  set(CPACK_RPM_PACKAGE_NAME "libgtirb-functions")
+  set(CPACK_RPM_FILE_NAME "${CPACK_RPM_PACKAGE_NAME}.rpm")
+  set(CPACK_RPM_PACKAGE_REQUIRES "libgtirb = ${CPACK_GTIRB_VERSION}")
+
+elseif("${CPACK_GTIRB_FUNCTIONS_PACKAGE}" STREQUAL "lib-dbg")
+  set(CPACK_PACKAGE_NAME "libgtirb-functions-dbg")
+  set(CPACK_PACKAGE_FILE_NAME "libgtirb-functions-dbg")
+  set(CPACK_COMPONENTS_ALL library-debug-file)
+  set(CPACK_DEBIAN_PACKAGE_DEPENDS
+      "libgtirb-functions (=${CPACK_GTIRB_FUNCTIONS_VERSION}-${CPACK_UBUNTU_NAME})"
+  )
 
 endif()
@@ -29,9 +29,42 @@
    (blocks :initarg :blocks :accessor blocks :type list
            :documentation "Blocks in the function.")
    (entries :initarg :entries :accessor entries :type list
-            :documentation "Blocks serving as entry points to the function."))
+            :documentation "Blocks serving as entry points to the function.")
+   ;; Computed on first use, and forgotten when blocks or module change.
+   (block-table :type hash-table
+                :documentation "Hash table of the UUIDs of the blocks.")
+   (exits :type list :documentation "Memoized `exits'.")
+   (returns :type list :documentation "Memoized `returns'.")
+   (tail-calls :type list :documentation "Memoized `tail-calls'."))
   (:documentation "A function in a GTIRB instance."))
 
+(defmacro memoized ((obj slot) &body body)
+  "Return SLOT of OBJ, first setting it to the value of BODY if unbound."
+  (once-only (obj)
+    `(if (slot-boundp ,obj ',slot)
+         (slot-value ,obj ',slot)
+         (setf (slot-value ,obj ',slot) (progn ,@body)))))
+
+(defun forget-memoized (func)
+  "Drop the memoized block table, exits, returns and tail calls of FUNC."
+  (dolist (slot '(block-table exits returns tail-calls))
+    (slot-makunbound func slot)))
+
+(defmethod (setf blocks) :after (new (obj func))
+  (declare (ignore new))
+  (forget-memoized obj))
+
+(defmethod (setf module) :after (new (obj func))
+  (declare (ignore new))
+  (forget-memoized obj))
+
+(defun block-table (func)
+  "Return a hash table holding the UUIDs of the blocks of FUNC."
+  (memoized (func block-table)
+    (let ((table (make-hash-table)))
+      (dolist (block (blocks func) table)
+        (setf (gethash (uuid block) table) t)))))
+
 (defmethod print-object ((obj func) stream)
   (print-unreadable-object (obj stream :type t :identity t)
     (format stream "~a ~d/~d"
@@ -43,37 +76,93 @@
 (defgeneric exits (object)
   (:documentation "Return the blocks that exit OBJECT.")
   (:method ((obj func))
-    (let ((cfg (cfg (gtirb (module obj)))))
-      (remove-if-not ; Blocks with non-call edges leaving the function.
-       [{some «and [#'not {eql :call} #'edge-type {edge-value cfg}]
-                   [#'not {member _ (mapcar #'uuid (blocks obj))} #'second]»}
-        {node-edges cfg} #'uuid]
-       (blocks obj)))))
+    (memoized (obj exits)
+      (let ((cfg (cfg (gtirb (module obj))))
+            (members (block-table obj)))
+        (remove-if-not ; Blocks with non-call edges leaving the function.
+         [{some «and [#'exit-edge-p {edge-value cfg}]
+                     [#'not {gethash _ members} #'second]»}
+          {node-edges cfg} #'uuid]
+         (blocks obj))))))
 
 (defgeneric returns (object)
   (:documentation "Return the blocks that return from OBJECT.")
   (:method ((obj func))
-    (remove-if-not [{some [{eql :ret} #'mnemonic]} #'instructions]
-                   (blocks obj))))
+    (memoized (obj returns)
+      (remove-if-not [{some [{eql :ret} #'mnemonic]} #'instructions]
+                     (blocks obj)))))
 
 (defgeneric tail-calls (object)
   (:documentation "Return the blocks that tail-call out of OBJECT.")
   (:method ((obj func))
-    (let ((cfg (cfg (gtirb (module obj)))))
-      (remove-if-not
-       (lambda (exit-block)
-         (when-let* ((uuid (uuid exit-block))
-                     (exit-edges (remove-if-not [{= uuid} #'first]
-                                                (node-edges cfg uuid)))
-                     (edge-value (edge-value cfg (first exit-edges))))
-           (and (= 1 (length exit-edges))
-                (not (conditional edge-value))
-                (eql :branch (edge-type edge-value)))))
-       (blocks obj)))))
+    (memoized (obj tail-calls)
+      (let ((cfg (cfg (gtirb (module obj)))))
+        (remove-if-not
+         (lambda (exit-block)
+           (when-let* ((uuid (uuid exit-block))
+                       (exit-edges (remove-if-not [{= uuid} #'first]
+                                                  (node-edges cfg uuid)))
+                       (edge-value (edge-value cfg (first exit-edges))))
+             (and (= 1 (length exit-edges))
+                  (tail-call-edge-p edge-value))))
+         (blocks obj))))))
+
+(defun exit-edge-p (edge-value)
+  "Return true if an edge labeled EDGE-VALUE, to a block outside a
+function, makes its source an exit. Unlabeled edges never do."
+  (and edge-value (not (eql :call (edge-type edge-value)))))
+
+(defun tail-call-edge-p (edge-value)
+  "Return true if an edge labeled EDGE-VALUE, as the only edge out of a
+block, makes the block a tail call."
+  (and (not (conditional edge-value))
+       (eql :branch (edge-type edge-value))))
+
+(defun summarize-functions (funcs cfg)
+  "Memoize the exits and tail calls of FUNCS from one pass over the edges
+of CFG, rather than one pass over the edges of each block per function.
+Return FUNCS."
+  (let ((owners (make-hash-table))     ; Block UUID to functions holding it.
+        (exit-uuids (make-hash-table)) ; Function to hash of exit block UUIDs.
+        (out-edges (make-hash-table))) ; Block UUID to (count . edge value).
+    (dolist (func funcs)
+      (dolist (block (blocks func))
+        (push func (gethash (uuid block) owners)))
+      (setf (gethash func exit-uuids) (make-hash-table)))
+    (dolist (edge (edges cfg))
+      (when-let ((source-owners (gethash (first edge) owners)))
+        (let ((value (edge-value cfg edge))
+              (out (ensure-gethash (first edge) out-edges (cons 0 nil))))
+          (incf (car out))
+          (setf (cdr out) value)
+          (when (exit-edge-p value)
+            (dolist (func source-owners)
+              (unless (member func (gethash (second edge) owners))
+                (setf (gethash (first edge) (gethash func exit-uuids)) t)))))))
+    (dolist (func funcs funcs)
+      (let ((exits (gethash func exit-uuids)))
+        (setf (slot-value func 'exits)
+              (remove-if-not [{gethash _ exits} #'uuid] (blocks func))
+              (slot-value func 'tail-calls)
+              (remove-if-not
+               (lambda (block)
+                 (when-let ((out (gethash (uuid block) out-edges)))
+                   (and (= 1 (car out))
+                        (cdr out)
+                        (tail-call-edge-p (cdr out)))))
+               (blocks func)))))))
 
 (defgeneric functions (object)
-  (:documentation "Return all functions in OBJECT.")
-  (:method ((obj gtirb)) (mappend #'functions (modules obj)))
+  (:documentation "Return all functions in OBJECT, with their exits and
+tail calls computed in one pass over the CFG.")
+  (:method ((obj gtirb))
+    (summarize-functions (mappend #'module-functions (modules obj))
+                         (cfg obj)))
+  (:method ((obj module))
+    (summarize-functions (module-functions obj) (cfg (gtirb obj)))))
+
+(defgeneric module-functions (module)
+  (:documentation "Return the functions of MODULE, without their exits.")
   (:method ((obj module) &aux results)
     (let ((entries
            (aux-data-data (cdr (assoc "functionEntries"
@@ -139,3 +228,28 @@
       (is (some #'returns hello-functions))
       (is (every «>= [#'length #'exits] [#'length #'returns]»
                  hello-functions)))))
+
+(deftest functions-memoize-one-pass-summaries ()
+  (with-fixture hello
+    (flet ((fresh (function)
+             (make-instance 'func
+               :module (module function) :name (name function)
+               :blocks (blocks function) :entries (entries function))))
+      (let ((hello-functions (functions *hello*)))
+        ;; The one-pass exits and tail calls match per-function ones.
+        (is (every (lambda (function)
+                     (let ((copy (fresh function)))
+                       (and (equal (exits function) (exits copy))
+                            (equal (tail-calls function) (tail-calls copy)))))
+                   hello-functions))
+        ;; Memoized results are reused, and dropped when blocks change.
+        (let ((function (find-if #'exits hello-functions)))
+          (is (eq (exits function) (exits function)))
+          (is (eq (returns function) (returns function)))
+          (setf (blocks function) (list (first (blocks function))))
+          (is (not (slot-boundp function 'exits)))
+          (is (subsetp (exits function) (blocks function))))))))
+
+(deftest unlabeled-edges-are-not-exits ()
+  ;; Both the per-function and the one-pass exits go through EXIT-EDGE-P.
+  (is (not (exit-edge-p nil))))
@@ -10,7 +10,22 @@
 # reflect the position or policy of the Government and no official
 # endorsement should be inferred.
 #
-__all__ = ["Function", "__version__"]
+__all__ = [
+    "Function",
+    "FunctionRecord",
+    "HAVE_NATIVE",
+    "ModuleRecord",
+    "load_function_records",
+    "module_records",
+    "__version__",
+]
 
 from .function import Function
+from .records import (
+    HAVE_NATIVE,
+    FunctionRecord,
+    ModuleRecord,
+    load_function_records,
+    module_records,
+)
 from .version import __version__
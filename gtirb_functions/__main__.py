@@ -12,31 +12,139 @@
 # endorsement should be inferred.
 #
 import argparse
+import csv
+import io
+import json
 import logging
+import multiprocessing
+import sys
+from typing import Iterable, List, Optional, Tuple
 from gtirb import IR
 from .function import Function
+from .records import ModuleRecord, load_function_records
 
+# The columns of the summary formats, one row per function
+SUMMARY_FIELDS = [
+    "file",
+    "module",
+    "name",
+    "uuid",
+    "entry_blocks",
+    "exit_blocks",
+    "blocks",
+    "low_address",
+    "high_address",
+]
 
-def main() -> None:
-    ap = argparse.ArgumentParser(description="Show functions in GTIRB")
-    ap.add_argument("infile")
-    ap.add_argument(
-        "-v", "--verbose", action="store_true", help="Verbose output"
-    )
 
-    args = ap.parse_args()
-    logging.basicConfig(format="%(message)s")
-    logger = logging.getLogger("gtirb.functions")
-    if args.verbose:
-        logger.setLevel(logging.DEBUG)
+def address_range(
+    module: ModuleRecord, blocks: Iterable[int]
+) -> Tuple[Optional[int], Optional[int]]:
+    """The lowest address of the given blocks and the address just past the
+    end of the highest one, or None if no block has an address."""
+
+    low = high = None
+    for index in blocks:
+        address = module.block_addresses[index]
+        if address is not None:
+            end = address + module.block_sizes[index]
+            low = address if low is None else min(low, address)
+            high = end if high is None else max(high, end)
+    return low, high
+
+
+def summarize(path: str, compute_exits: bool) -> List[list]:
+    """One summary row per function of the GTIRB file at path."""
+
+    rows = []
+    for module in load_function_records(path, compute_exits):
+        for fn in module.functions:
+            name = fn.name or (fn.names[0] if fn.names else "<unknown>")
+            low, high = address_range(module, fn.blocks)
+            rows.append(
+                [
+                    path,
+                    module.name,
+                    name,
+                    str(fn.uuid),
+                    len(fn.entry_blocks),
+                    len(fn.exit_blocks) if compute_exits else None,
+                    len(fn.blocks),
+                    low,
+                    high,
+                ]
+            )
+    return rows
+
+
+def format_rows(rows: List[list], output_format: str) -> str:
+    """Format summary rows as NDJSON or CSV lines."""
+
+    if output_format == "ndjson":
+        return "".join(
+            json.dumps(dict(zip(SUMMARY_FIELDS, row))) + "\n" for row in rows
+        )
+    out = io.StringIO()
+    csv.writer(out, lineterminator="\n").writerows(rows)
+    return out.getvalue()
+
+
+def summarize_file(
+    args: Tuple[str, bool, str]
+) -> Tuple[str, Optional[str], Optional[str]]:
+    """Worker for batch mode: return the formatted summary of one file, or
+    the error that prevented it."""
+
+    path, compute_exits, output_format = args
+    try:
+        rows = summarize(path, compute_exits)
+        return path, format_rows(rows, output_format), None
+    except Exception as e:
+        return path, None, "{}: {}".format(type(e).__name__, e)
+
+
+def run_batch(
+    paths: List[str], compute_exits: bool, output_format: str, jobs: int
+) -> int:
+    """Stream the summaries of all the files, in the order given, while up to
+    jobs processes work on later ones. Returns the number of failures."""
+
+    if output_format == "csv":
+        csv.writer(sys.stdout, lineterminator="\n").writerow(SUMMARY_FIELDS)
+
+    work = [(path, compute_exits, output_format) for path in paths]
+    failures = 0
+
+    def write(results: Iterable[Tuple[str, Optional[str], Optional[str]]]):
+        nonlocal failures
+        for path, text, error in results:
+            if error is not None:
+                logging.getLogger("gtirb.functions").error(
+                    "%s: %s", path, error
+                )
+                failures += 1
+            else:
+                sys.stdout.write(text)
+                sys.stdout.flush()
+
+    if jobs == 1 or len(paths) == 1:
+        write(map(summarize_file, work))
+    else:
+        with multiprocessing.Pool(jobs or None) as pool:
+            write(pool.imap(summarize_file, work))
+    return failures
+
+
+def print_functions(path: str, logger: logging.Logger) -> None:
+    """Print the functions of the GTIRB file at path in full."""
 
     logger.info("Loading IR...")
-    ir = IR.load_protobuf(args.infile)
+    ir = IR.load_protobuf(path)
 
     logger.info("Identifying functions...")
 
     for m in ir.modules:
-        fns = Function.build_functions(m)
+        fns = Function.build_functions(m, compute_exits=True)
         fns.sort(key=lambda x: x.get_name())
         if len(fns) > 0:
             print("Module: %s" % m.name)
@@ -44,6 +152,50 @@ def main() -> None:
                 print("\tFunction: %s" % fn.get_name())
                 print(fn)
 
+
+def main() -> None:
+    ap = argparse.ArgumentParser(description="Show functions in GTIRB")
+    ap.add_argument("infile", nargs="+")
+    ap.add_argument(
+        "-v", "--verbose", action="store_true", help="Verbose output"
+    )
+    ap.add_argument(
+        "-f",
+        "--format",
+        choices=["text", "ndjson", "csv"],
+        default="text",
+        help="Print every function in full (text), or one summary line "
+        "per function (ndjson, csv)",
+    )
+    ap.add_argument(
+        "-j",
+        "--jobs",
+        type=int,
+        default=1,
+        help="Number of worker processes for the summary formats, "
+        "0 for one per processor",
+    )
+    ap.add_argument(
+        "--no-exits",
+        action="store_true",
+        help="Do not compute exit blocks in the summary formats",
+    )
+
+    args = ap.parse_args()
+    logging.basicConfig(format="%(message)s")
+    logger = logging.getLogger("gtirb.functions")
+    if args.verbose:
+        logger.setLevel(logging.DEBUG)
+
+    if args.format != "text":
+        failures = run_batch(
+            args.infile, not args.no_exits, args.format, args.jobs
+        )
+        sys.exit(1 if failures else 0)
+
+    for path in args.infile:
+        print_functions(path, logger)
+
     logger.info("Done.")
 
 
@@ -61,8 +61,16 @@ class Function(object):
             self._name_symbols.append(canonical_name_symbol)
 
     @classmethod
-    def build_functions(cls, module: gtirb.Module) -> List["Function"]:
-        """Given a module, generate all the functions associated with it."""
+    def build_functions(
+        cls, module: gtirb.Module, compute_exits: bool = False
+    ) -> List["Function"]:
+        """Given a module, generate all the functions associated with it.
+
+        :param module: The module to generate functions for.
+        :param compute_exits: If True, compute the exit blocks of all the
+        functions at once, in a single pass over the CFG edges, rather than
+        one function at a time on the first call to get_exit_blocks.
+        """
 
         symbols = collections.defaultdict(set)
         for symbol in module.symbols:
@@ -85,8 +93,52 @@ class Function(object):
                     canonical_name_symbol=name,
                 )
             )
+        if compute_exits:
+            cls._compute_exit_blocks(module, functions)
         return functions
 
+    @staticmethod
+    def _compute_exit_blocks(
+        module: gtirb.Module, functions: List["Function"]
+    ) -> None:
+        """Fill in the exit blocks of all of the given functions of a module
+        in one pass over the CFG edges, with the same result as calling
+        get_exit_blocks on each of them.
+        """
+
+        # Map each block to the indices of the functions containing it.
+        owners = collections.defaultdict(list)
+        for index, function in enumerate(functions):
+            function._exit_blocks = set()
+            for block in function._blocks:
+                owners[block].append(index)
+
+        if module.ir is None:
+            return
+
+        calls = {gtirb.Edge.Type.Call, gtirb.Edge.Type.Syscall}
+        returns = {gtirb.Edge.Type.Return, gtirb.Edge.Type.Sysret}
+        for edge in module.ir.cfg:
+            if not edge.label or not isinstance(edge.source, gtirb.CodeBlock):
+                continue
+            source_owners = owners.get(edge.source)
+            if not source_owners:
+                continue
+            edge_type = edge.label.type
+            if edge_type in returns:
+                exits_from = source_owners
+            elif edge_type in calls:
+                continue
+            else:
+                target_owners = owners.get(edge.target, ())
+                exits_from = [
+                    index
+                    for index in source_owners
+                    if index not in target_owners
+                ]
+            for index in exits_from:
+                functions[index]._exit_blocks.add(edge.source)
+
     def get_name(self) -> str:
         """Get the name of this function as a str."""
 
@@ -0,0 +1,147 @@
+#
+# Copyright (C) 2021 GrammaTech, Inc.
+#
+# This code is licensed under the MIT license. See the LICENSE file in
+# the project root for license terms.
+#
+# This project is sponsored by the Office of Naval Research, One Liberty
+# Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+# N68335-17-C-0700.  The content of the information does not necessarily
+# reflect the position or policy of the Government and no official
+# endorsement should be inferred.
+#
+"""Compact, index-based descriptions of the functions of GTIRB files.
+
+The records are built by the gtirb_functions._native extension when it is
+installed, which runs the C++ construction of gtirb_functions.hpp, and by
+the pure-Python Function class otherwise. Both give the same records, with
+the functions of each module ordered by UUID.
+"""
+import uuid
+from typing import Any, List, NamedTuple, Optional, Tuple
+
+import gtirb
+
+from .function import Function
+
+try:
+    from . import _native  # type: ignore
+except ImportError:
+    _native = None
+
+HAVE_NATIVE = _native is not None
+"""Whether records are built by the compiled extension."""
+
+
+class FunctionRecord(NamedTuple):
+    """A function, with its blocks given by index in the block table of its
+    ModuleRecord. Indices are in increasing order."""
+
+    uuid: uuid.UUID
+    name: Optional[str]
+    """The FunctionNames name of the function, if any."""
+    names: Tuple[str, ...]
+    """Every name of the function, sorted."""
+    entry_blocks: Tuple[int, ...]
+    exit_blocks: Tuple[int, ...]
+    """Empty unless exits were computed."""
+    blocks: Tuple[int, ...]
+
+
+class ModuleRecord(NamedTuple):
+    """The functions of a module, and a table of their blocks, numbered in
+    address order. Blocks without an address come last, ordered by UUID."""
+
+    name: str
+    block_uuids: List[uuid.UUID]
+    block_addresses: List[Optional[int]]
+    block_sizes: List[int]
+    functions: List[FunctionRecord]
+    """Ordered by UUID."""
+
+
+def module_records(
+    module: gtirb.Module, compute_exits: bool = True
+) -> ModuleRecord:
+    """Describe the functions of a loaded module, in pure Python."""
+
+    functions = Function.build_functions(module, compute_exits=compute_exits)
+
+    blocks = set()
+    for function in functions:
+        blocks.update(function.get_all_blocks())
+        blocks.update(function.get_entry_blocks())
+
+    def block_key(block: Any) -> Tuple[bool, int, uuid.UUID]:
+        address = block.address
+        return (address is None, address or 0, block.uuid)
+
+    table = sorted(blocks, key=block_key)
+    index = {block: i for i, block in enumerate(table)}
+
+    def indices(function_blocks: Any) -> Tuple[int, ...]:
+        return tuple(sorted(index[block] for block in function_blocks))
+
+    records = []
+    for function in sorted(functions, key=lambda function: function.uuid):
+        canonical = function.canonical_name_symbol
+        records.append(
+            FunctionRecord(
+                uuid=function.uuid,
+                name=canonical.name if canonical else None,
+                names=tuple(sorted(set(function.names))),
+                entry_blocks=indices(function.get_entry_blocks()),
+                exit_blocks=indices(function.get_exit_blocks())
+                if compute_exits
+                else (),
+                blocks=indices(function.get_all_blocks()),
+            )
+        )
+    return ModuleRecord(
+        name=module.name,
+        block_uuids=[block.uuid for block in table],
+        block_addresses=[block.address for block in table],
+        block_sizes=[block.size for block in table],
+        functions=records,
+    )
+
+
+def load_function_records(
+    path: str, compute_exits: bool = True, num_threads: int = 1
+) -> List[ModuleRecord]:
+    """Describe the functions of every module of the GTIRB file at path.
+
+    :param path: The GTIRB file.
+    :param compute_exits: Whether to compute exit blocks.
+    :param num_threads: The number of threads the compiled extension may use,
+    zero meaning one per processor. Ignored by the pure-Python fallback.
+    """
+
+    if _native is None:
+        ir = gtirb.IR.load_protobuf(path)
+        return [module_records(m, compute_exits) for m in ir.modules]
+
+    result = []
+    for module in _native.build_functions(path, compute_exits, num_threads):
+        name, packed_uuids, addresses, sizes, functions = module
+        result.append(
+            ModuleRecord(
+                name=name,
+                block_uuids=[
+                    uuid.UUID(bytes=packed_uuids[i : i + 16])
+                    for i in range(0, len(packed_uuids), 16)
+                ],
+                block_addresses=addresses,
+                block_sizes=sizes,
+                functions=sorted(
+                    (
+                        FunctionRecord(
+                            uuid.UUID(bytes=fn_uuid), fn_name, names, *blocks
+                        )
+                        for fn_uuid, fn_name, names, *blocks in functions
+                    ),
+                    key=lambda record: record.uuid,
+                ),
+            )
+        )
+    return result
@@ -0,0 +1,319 @@
+//===- block_bitset.hpp -----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_FN_BLOCK_BITSET_H
+#define GTIRB_FN_BLOCK_BITSET_H
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace gtirb {
+
+namespace detail {
+
+inline unsigned popcount64(uint64_t Word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(__builtin_popcountll(Word));
+#else
+  return static_cast<unsigned>(std::bitset<64>(Word).count());
+#endif
+}
+
+inline unsigned countTrailingZeros64(uint64_t Word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(__builtin_ctzll(Word));
+#else
+  unsigned N = 0;
+  while (!(Word & 1)) {
+    Word >>= 1;
+    ++N;
+  }
+  return N;
+#endif
+}
+
+} // namespace detail
+
+/// \class BlockBitset is a set of dense block indices, stored as a window of
+/// 64-bit words.
+///
+/// Only the words from the one holding the smallest index to the one holding
+/// the largest are stored. Blocks numbered in address order make a
+/// function's blocks nearly contiguous, so the window of a function is about
+/// as many bits as it has blocks, wherever the function lies in the module.
+///
+/// Set operations only visit the words where both windows overlap, in flat
+/// loops over word arrays that compilers vectorize.
+class BlockBitset {
+public:
+  using index_type = uint32_t;
+  using word_type = uint64_t;
+
+  static constexpr unsigned WordBits = 64;
+
+  /// \brief Create an empty set
+  BlockBitset() = default;
+
+  /// \brief Create the set of \p Indices, in any order
+  template <class RangeType> explicit BlockBitset(const RangeType& Indices) {
+    bool Any = false;
+    index_type Min = 0;
+    index_type Max = 0;
+    for (index_type I : Indices) {
+      Min = Any ? std::min(Min, I) : I;
+      Max = Any ? std::max(Max, I) : I;
+      Any = true;
+    }
+    if (!Any) {
+      return;
+    }
+    FirstWord = Min / WordBits;
+    Words.assign(Max / WordBits - FirstWord + 1, 0);
+    for (index_type I : Indices) {
+      Words[I / WordBits - FirstWord] |= word_type(1) << (I % WordBits);
+    }
+  }
+
+  /// \brief Return whether the set is empty
+  bool empty() const { return Words.empty(); }
+
+  /// \brief Return the number of indices in the set
+  size_t count() const {
+    size_t N = 0;
+    for (word_type W : Words) {
+      N += detail::popcount64(W);
+    }
+    return N;
+  }
+
+  /// \brief Return whether \p I is in the set
+  bool test(index_type I) const {
+    size_t Word = I / WordBits;
+    if (Word < FirstWord || Word - FirstWord >= Words.size()) {
+      return false;
+    }
+    return (Words[Word - FirstWord] >> (I % WordBits)) & 1;
+  }
+
+  /// \brief Return the number of words stored
+  size_t num_words() const { return Words.size(); }
+
+  /// \brief Return the index of the first stored word
+  size_t first_word() const { return FirstWord; }
+
+  /// \brief Return whether the set shares an index with \p Other
+  bool intersects(const BlockBitset& Other) const {
+    auto [Begin, End] = overlap(Other);
+    if (Begin == End) {
+      return false;
+    }
+    const word_type* A = word(Begin);
+    const word_type* B = Other.word(Begin);
+    // In blocks of words, so that each block is a vectorizable loop
+    constexpr size_t Chunk = 8;
+    for (size_t I = 0; I < End - Begin; I += Chunk) {
+      size_t N = std::min(Chunk, End - Begin - I);
+      word_type Any = 0;
+      for (size_t J = 0; J < N; ++J) {
+        Any |= A[I + J] & B[I + J];
+      }
+      if (Any) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// \brief Return the number of indices in both the set and \p Other
+  size_t intersection_count(const BlockBitset& Other) const {
+    auto [Begin, End] = overlap(Other);
+    if (Begin == End) {
+      return 0;
+    }
+    const word_type* A = word(Begin);
+    const word_type* B = Other.word(Begin);
+    size_t N = 0;
+    for (size_t I = 0; I < End - Begin; ++I) {
+      N += detail::popcount64(A[I] & B[I]);
+    }
+    return N;
+  }
+
+  /// \brief Keep only the indices also in \p Other
+  BlockBitset& operator&=(const BlockBitset& Other) {
+    auto [Begin, End] = overlap(Other);
+    if (Begin == End) {
+      *this = BlockBitset();
+      return *this;
+    }
+    std::vector<word_type> Result(End - Begin);
+    const word_type* A = word(Begin);
+    const word_type* B = Other.word(Begin);
+    for (size_t I = 0; I < Result.size(); ++I) {
+      Result[I] = A[I] & B[I];
+    }
+    FirstWord = static_cast<index_type>(Begin);
+    Words = std::move(Result);
+    trim();
+    return *this;
+  }
+
+  /// \brief Add the indices of \p Other
+  BlockBitset& operator|=(const BlockBitset& Other) {
+    if (Other.empty()) {
+      return *this;
+    }
+    if (empty()) {
+      return *this = Other;
+    }
+    size_t Begin = std::min(FirstWord, Other.FirstWord);
+    size_t End = std::max(endWord(), Other.endWord());
+    if (Begin != FirstWord || End != endWord()) {
+      std::vector<word_type> Grown(End - Begin, 0);
+      std::copy(Words.begin(), Words.end(),
+                Grown.begin() + (FirstWord - Begin));
+      FirstWord = static_cast<index_type>(Begin);
+      Words = std::move(Grown);
+    }
+    word_type* A = Words.data() + (Other.FirstWord - FirstWord);
+    const word_type* B = Other.Words.data();
+    for (size_t I = 0; I < Other.Words.size(); ++I) {
+      A[I] |= B[I];
+    }
+    return *this;
+  }
+
+  friend BlockBitset operator&(BlockBitset A, const BlockBitset& B) {
+    return A &= B;
+  }
+
+  friend BlockBitset operator|(BlockBitset A, const BlockBitset& B) {
+    return A |= B;
+  }
+
+  friend bool operator==(const BlockBitset& A, const BlockBitset& B) {
+    return A.FirstWord == B.FirstWord && A.Words == B.Words;
+  }
+
+  friend bool operator!=(const BlockBitset& A, const BlockBitset& B) {
+    return !(A == B);
+  }
+
+  /// \brief Return the indices in at least one of \p Sets
+  static BlockBitset unite(const std::vector<BlockBitset>& Sets) {
+    return uniteAndShare(Sets).first;
+  }
+
+  /// \brief Return the indices in at least two of \p Sets
+  static BlockBitset shared(const std::vector<BlockBitset>& Sets) {
+    return uniteAndShare(Sets).second;
+  }
+
+  /// \brief Call \p F with each index in the set, in increasing order
+  template <class FnType> void for_each(FnType F) const {
+    for (size_t I = 0; I < Words.size(); ++I) {
+      for (word_type W = Words[I]; W; W &= W - 1) {
+        F(static_cast<index_type>((FirstWord + I) * WordBits +
+                                  detail::countTrailingZeros64(W)));
+      }
+    }
+  }
+
+  /// \brief Return the indices in the set, in increasing order
+  std::vector<index_type> indices() const {
+    std::vector<index_type> Result;
+    Result.reserve(count());
+    for_each([&Result](index_type I) { Result.push_back(I); });
+    return Result;
+  }
+
+private:
+  size_t endWord() const { return FirstWord + Words.size(); }
+
+  /// \brief Return a pointer to the stored word with index \p I
+  const word_type* word(size_t I) const {
+    return Words.data() + (I - FirstWord);
+  }
+
+  /// \brief Return the range of word indices stored in both sets, which is
+  /// empty if they do not overlap
+  std::pair<size_t, size_t> overlap(const BlockBitset& Other) const {
+    size_t Begin = std::max<size_t>(FirstWord, Other.FirstWord);
+    size_t End = std::min(endWord(), Other.endWord());
+    return {Begin, std::max(Begin, End)};
+  }
+
+  /// \brief Compute unite() and shared() in one pass, over one window
+  /// spanning all of \p Sets
+  static std::pair<BlockBitset, BlockBitset>
+  uniteAndShare(const std::vector<BlockBitset>& Sets) {
+    size_t Begin = SIZE_MAX;
+    size_t End = 0;
+    for (const BlockBitset& Set : Sets) {
+      if (!Set.empty()) {
+        Begin = std::min<size_t>(Begin, Set.FirstWord);
+        End = std::max(End, Set.endWord());
+      }
+    }
+    BlockBitset Seen;
+    BlockBitset Shared;
+    if (Begin >= End) {
+      return {Seen, Shared};
+    }
+    Seen.FirstWord = Shared.FirstWord = static_cast<index_type>(Begin);
+    Seen.Words.assign(End - Begin, 0);
+    Shared.Words.assign(End - Begin, 0);
+    for (const BlockBitset& Set : Sets) {
+      if (Set.empty()) {
+        continue;
+      }
+      word_type* S = Seen.Words.data() + (Set.FirstWord - Begin);
+      word_type* D = Shared.Words.data() + (Set.FirstWord - Begin);
+      const word_type* W = Set.Words.data();
+      for (size_t I = 0; I < Set.Words.size(); ++I) {
+        D[I] |= S[I] & W[I];
+        S[I] |= W[I];
+      }
+    }
+    Seen.trim();
+    Shared.trim();
+    return {std::move(Seen), std::move(Shared)};
+  }
+
+  /// \brief Drop zero words at either end, keeping the window canonical
+  void trim() {
+    auto First = std::find_if(Words.begin(), Words.end(),
+                              [](word_type W) { return W != 0; });
+    if (First == Words.end()) {
+      Words.clear();
+      FirstWord = 0;
+      return;
+    }
+    auto Last = std::find_if(Words.rbegin(), Words.rend(),
+                             [](word_type W) { return W != 0; })
+                    .base();
+    FirstWord += static_cast<index_type>(First - Words.begin());
+    Words = std::vector<word_type>(First, Last);
+  }
+
+  index_type FirstWord = 0;
+  std::vector<word_type> Words;
+};
+
+} // namespace gtirb
+
+#endif // GTIRB_FN_BLOCK_BITSET_H
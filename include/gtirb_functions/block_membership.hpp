@@ -0,0 +1,227 @@
+//===- block_membership.hpp -------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_FN_BLOCK_MEMBERSHIP_H
+#define GTIRB_FN_BLOCK_MEMBERSHIP_H
+
+#include "block_bitset.hpp"
+#include "gtirb_functions.hpp"
+#include "local_cfg.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gtirb {
+
+/// \class BlockNumbering numbers the code blocks of a set of functions
+/// densely from zero.
+///
+/// Blocks are numbered in address order, with blocks without an address
+/// last and ties broken by UUID, as in \ref LocalCFG. Every block of a
+/// function, entry or not, gets a number.
+class BlockNumbering {
+public:
+  using index_type = BlockBitset::index_type;
+
+  /// \brief Create an empty numbering
+  BlockNumbering() = default;
+
+  /// \brief Number the blocks of \p Fns
+  template <class ModuleType>
+  explicit BlockNumbering(const std::vector<Function<ModuleType>>& Fns) {
+    for (const auto& Fn : Fns) {
+      for (const CodeBlock* Block : Fn.all_blocks()) {
+        Blocks.push_back(Block);
+      }
+      for (const CodeBlock* Block : Fn.entry_blocks()) {
+        Blocks.push_back(Block);
+      }
+    }
+    std::sort(Blocks.begin(), Blocks.end(), detail::blockAddressOrder);
+    Blocks.erase(std::unique(Blocks.begin(), Blocks.end()), Blocks.end());
+
+    ByPointer.reserve(Blocks.size());
+    for (size_t I = 0; I < Blocks.size(); ++I) {
+      ByPointer.emplace(Blocks[I], static_cast<index_type>(I));
+    }
+  }
+
+  /// \brief Return the number of blocks
+  size_t size() const { return Blocks.size(); }
+
+  /// \brief Return the block with index \p I
+  const CodeBlock* block(index_type I) const { return Blocks[I]; }
+
+  /// \brief Return the index of \p Node, if it is a block of some function
+  ///
+  /// A hash table lookup.
+  std::optional<index_type> index(const CfgNode* Node) const {
+    auto It = ByPointer.find(Node);
+    if (It == ByPointer.end()) {
+      return std::nullopt;
+    }
+    return It->second;
+  }
+
+  /// \brief Return the indices of \p Blocks that are numbered
+  template <class RangeType>
+  std::vector<index_type> indices(const RangeType& Range) const {
+    std::vector<index_type> Result;
+    for (const CodeBlock* Block : Range) {
+      if (auto I = index(Block)) {
+        Result.push_back(*I);
+      }
+    }
+    return Result;
+  }
+
+private:
+  std::vector<const CodeBlock*> Blocks;
+  std::unordered_map<const CfgNode*, index_type> ByPointer;
+};
+
+/// \class BlockMembership<T> holds the blocks of each of a set of functions
+/// as a \ref BlockBitset over a shared \ref BlockNumbering.
+///
+/// Functions are identified by their position in the vector the membership
+/// was built from, like \ref CallGraph nodes. Blocks are identified either
+/// by pointer, which costs a hash lookup in the numbering, or by their index
+/// in it, which makes a membership test a bit test. Questions about several
+/// functions, such as which functions share blocks, are word-wise operations
+/// on bitsets instead of hash set lookups.
+template <class ModuleType> class BlockMembership {
+public:
+  using FunctionType = Function<ModuleType>;
+  using index_type = BlockNumbering::index_type;
+
+  /// \brief Two functions sharing blocks
+  struct Overlap {
+    /// \brief The functions, with First < Second
+    uint32_t First;
+    uint32_t Second;
+
+    /// \brief The number of blocks they share
+    size_t Shared;
+  };
+
+  /// \brief Number the blocks of \p Fns and build their bitsets on up to
+  /// \p NumThreads threads (zero means one per hardware thread)
+  explicit BlockMembership(const std::vector<FunctionType>& Fns,
+                           unsigned NumThreads = 1)
+      : Numbering(Fns), Sets(Fns.size()) {
+    if (NumThreads == 0) {
+      NumThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    detail::parallel_for(Fns.size(), 64, NumThreads, [&](size_t I) {
+      Sets[I] = BlockBitset(Numbering.indices(Fns[I].all_blocks()));
+    });
+    Covered = BlockBitset::unite(Sets);
+  }
+
+  /// \brief Return the numbering of the blocks
+  const BlockNumbering& numbering() const { return Numbering; }
+
+  /// \brief Return the number of functions
+  size_t size() const { return Sets.size(); }
+
+  /// \brief Return the blocks of function \p Fn
+  const BlockBitset& blocks(size_t Fn) const { return Sets[Fn]; }
+
+  /// \brief Return the blocks belonging to at least one function
+  const BlockBitset& covered() const { return Covered; }
+
+  /// \brief Return whether \p Block is a block of function \p Fn
+  bool contains(size_t Fn, const CfgNode* Block) const {
+    auto I = Numbering.index(Block);
+    return I && Sets[Fn].test(*I);
+  }
+
+  /// \brief Return whether the block numbered \p Block is a block of
+  /// function \p Fn
+  bool contains_index(size_t Fn, index_type Block) const {
+    return Sets[Fn].test(Block);
+  }
+
+  /// \brief Return whether \p Block is a block of any function
+  bool in_any_function(const CfgNode* Block) const {
+    auto I = Numbering.index(Block);
+    return I && Covered.test(*I);
+  }
+
+  /// \brief Return whether the block numbered \p Block is a block of any
+  /// function
+  bool index_in_any_function(index_type Block) const {
+    return Covered.test(Block);
+  }
+
+  /// \brief Return the blocks belonging to more than one function
+  BlockBitset shared() const { return BlockBitset::shared(Sets); }
+
+  /// \brief Return every pair of functions sharing blocks, sorted by first
+  /// and then second function
+  ///
+  /// Only pairs whose bitset windows overlap are compared, found by a sweep
+  /// over the functions in window order.
+  std::vector<Overlap> overlaps() const {
+    std::vector<uint32_t> Order;
+    for (size_t I = 0; I < Sets.size(); ++I) {
+      if (!Sets[I].empty()) {
+        Order.push_back(static_cast<uint32_t>(I));
+      }
+    }
+    std::sort(Order.begin(), Order.end(), [this](uint32_t A, uint32_t B) {
+      return Sets[A].first_word() < Sets[B].first_word();
+    });
+
+    std::vector<Overlap> Result;
+    std::vector<uint32_t> Active;
+    for (uint32_t Fn : Order) {
+      size_t Begin = Sets[Fn].first_word();
+      Active.erase(std::remove_if(Active.begin(), Active.end(),
+                                  [&](uint32_t Other) {
+                                    const BlockBitset& S = Sets[Other];
+                                    return S.first_word() + S.num_words() <=
+                                           Begin;
+                                  }),
+                   Active.end());
+      for (uint32_t Other : Active) {
+        if (size_t Shared = Sets[Fn].intersection_count(Sets[Other])) {
+          Result.push_back(
+              {std::min(Fn, Other), std::max(Fn, Other), Shared});
+        }
+      }
+      Active.push_back(Fn);
+    }
+    std::sort(Result.begin(), Result.end(),
+              [](const Overlap& A, const Overlap& B) {
+                return std::tie(A.First, A.Second) <
+                       std::tie(B.First, B.Second);
+              });
+    return Result;
+  }
+
+private:
+  BlockNumbering Numbering;
+  std::vector<BlockBitset> Sets;
+  BlockBitset Covered;
+};
+
+} // namespace gtirb
+
+#endif // GTIRB_FN_BLOCK_MEMBERSHIP_H
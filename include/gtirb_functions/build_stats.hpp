@@ -0,0 +1,221 @@
+//===- build_stats.hpp ------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_FN_BUILD_STATS_H
+#define GTIRB_FN_BUILD_STATS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+namespace gtirb {
+
+/// \class FunctionBuildStats records where the time of \ref build_functions
+/// goes and what it found.
+///
+/// Pass a pointer to one in \ref FunctionBuildOptions::Stats to have it
+/// filled in. Without one, nothing is measured or counted. Values are added
+/// to what the object already holds, so one object may collect several
+/// builds; assign `FunctionBuildStats()` to start over.
+///
+/// Times of the per-function phases are summed over all the threads building
+/// functions, and may exceed TotalTime in a parallel build.
+struct FunctionBuildStats {
+  using duration = std::chrono::nanoseconds;
+
+  /// \brief Resolving the UUIDs of the function AuxData tables, zero if a
+  /// resolver was supplied
+  duration ResolveTime{0};
+
+  /// \brief Indexing the symbols of the module by referent
+  duration SymbolTime{0};
+
+  /// \brief Looking up the entry and member blocks of each function
+  duration BlockTime{0};
+
+  /// \brief Looking up the names of each function: the symbols of its entry
+  /// blocks and its FunctionNames symbol
+  duration NamingTime{0};
+
+  /// \brief Classifying exit blocks, with ExitBlockMode::Eager
+  duration ExitTime{0};
+
+  /// \brief The whole build, from start to finish
+  duration TotalTime{0};
+
+  /// \brief The number of functions built
+  uint64_t Functions = 0;
+
+  /// \brief The number of AuxData references resolved to a node of the
+  /// expected kind
+  uint64_t ResolvedReferences = 0;
+
+  /// \brief The number of AuxData references dropped because they did not
+  /// resolve, see \ref UUIDResolver::dangling
+  uint64_t DanglingReferences = 0;
+
+  /// \brief The number of functions built with no blocks
+  uint64_t FunctionsWithoutBlocks = 0;
+
+  /// \brief The number of functions built with neither a FunctionNames
+  /// symbol nor a symbol on an entry block
+  uint64_t FunctionsWithoutNames = 0;
+
+  /// \brief An estimate of the memory held by the functions built, in bytes
+  uint64_t ResultBytes = 0;
+
+  /// \brief An estimate of the most memory held at once during the build, in
+  /// bytes: the result plus the lookup tables built for it
+  uint64_t PeakBytes = 0;
+
+  /// \brief Add the values of \p Other
+  ///
+  /// Peak memory is added as well, as the peak of builds running side by
+  /// side.
+  FunctionBuildStats& operator+=(const FunctionBuildStats& Other) {
+    ResolveTime += Other.ResolveTime;
+    SymbolTime += Other.SymbolTime;
+    BlockTime += Other.BlockTime;
+    NamingTime += Other.NamingTime;
+    ExitTime += Other.ExitTime;
+    TotalTime += Other.TotalTime;
+    Functions += Other.Functions;
+    ResolvedReferences += Other.ResolvedReferences;
+    DanglingReferences += Other.DanglingReferences;
+    FunctionsWithoutBlocks += Other.FunctionsWithoutBlocks;
+    FunctionsWithoutNames += Other.FunctionsWithoutNames;
+    ResultBytes += Other.ResultBytes;
+    PeakBytes += Other.PeakBytes;
+    return *this;
+  }
+
+  /// \brief Call \p F(Name, Value) for every value, for export to a metrics
+  /// system
+  ///
+  /// Names are snake case; times are in nanoseconds and end in `_ns`.
+  template <class FnType> void for_each(FnType F) const {
+    F(std::string_view("resolve_time_ns"), count(ResolveTime));
+    F(std::string_view("symbol_time_ns"), count(SymbolTime));
+    F(std::string_view("block_time_ns"), count(BlockTime));
+    F(std::string_view("naming_time_ns"), count(NamingTime));
+    F(std::string_view("exit_time_ns"), count(ExitTime));
+    F(std::string_view("total_time_ns"), count(TotalTime));
+    F(std::string_view("functions"), Functions);
+    F(std::string_view("resolved_references"), ResolvedReferences);
+    F(std::string_view("dangling_references"), DanglingReferences);
+    F(std::string_view("functions_without_blocks"), FunctionsWithoutBlocks);
+    F(std::string_view("functions_without_names"), FunctionsWithoutNames);
+    F(std::string_view("result_bytes"), ResultBytes);
+    F(std::string_view("peak_bytes"), PeakBytes);
+  }
+
+private:
+  static uint64_t count(duration D) {
+    return static_cast<uint64_t>(std::max<duration::rep>(0, D.count()));
+  }
+};
+
+namespace detail {
+
+/// \brief Estimate the memory held by the nodes and buckets of the unordered
+/// container \p C, in bytes
+template <class ContainerType> uint64_t unorderedBytes(const ContainerType& C) {
+  // Each node holds a value and a next pointer; each bucket, a pointer.
+  return C.bucket_count() * sizeof(void*) +
+         C.size() * (sizeof(typename ContainerType::value_type) +
+                     sizeof(void*));
+}
+
+/// \brief Estimate the memory held by the elements of the vector \p V, in
+/// bytes
+template <class VectorType> uint64_t vectorBytes(const VectorType& V) {
+  return V.capacity() * sizeof(typename VectorType::value_type);
+}
+
+using StatsClock = std::chrono::steady_clock;
+
+/// \brief Times of the per-function build phases, added to by every thread
+struct FunctionPhaseTimes {
+  std::atomic<int64_t> Blocks{0};
+  std::atomic<int64_t> Naming{0};
+};
+
+/// \brief Times the phases of building one function
+///
+/// Each lap() adds the time since the previous one, or since construction, to
+/// a phase of a \ref FunctionPhaseTimes.
+class FunctionPhaseTimer {
+public:
+  explicit FunctionPhaseTimer(FunctionPhaseTimes& T)
+      : Times(&T), Last(StatsClock::now()) {}
+
+  void lap(std::atomic<int64_t> FunctionPhaseTimes::*Phase) {
+    auto Now = StatsClock::now();
+    (Times->*Phase).fetch_add(
+        std::chrono::duration_cast<FunctionBuildStats::duration>(Now - Last)
+            .count(),
+        std::memory_order_relaxed);
+    Last = Now;
+  }
+
+private:
+  FunctionPhaseTimes* Times;
+  StatsClock::time_point Last;
+};
+
+/// \brief A \ref FunctionPhaseTimer that does nothing, for builds without
+/// stats
+struct NullPhaseTimer {
+  void lap(std::atomic<int64_t> FunctionPhaseTimes::*) {}
+};
+
+/// \brief Time the span from construction to stop() into a
+/// FunctionBuildStats duration, if there are stats to fill in
+class ScopedPhaseTimer {
+public:
+  ScopedPhaseTimer(FunctionBuildStats* S,
+                   FunctionBuildStats::duration FunctionBuildStats::*P)
+      : Stats(S), Phase(P) {
+    if (Stats) {
+      Start = StatsClock::now();
+    }
+  }
+
+  ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+  ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+  ~ScopedPhaseTimer() { stop(); }
+
+  /// \brief Record the time so far; later calls do nothing
+  void stop() {
+    if (Stats) {
+      Stats->*Phase += std::chrono::duration_cast<FunctionBuildStats::duration>(
+          StatsClock::now() - Start);
+      Stats = nullptr;
+    }
+  }
+
+private:
+  FunctionBuildStats* Stats;
+  FunctionBuildStats::duration FunctionBuildStats::*Phase;
+  StatsClock::time_point Start;
+};
+
+} // namespace detail
+
+} // namespace gtirb
+
+#endif // GTIRB_FN_BUILD_STATS_H
@@ -0,0 +1,252 @@
+//===- call_graph.hpp -------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_FN_CALL_GRAPH_H
+#define GTIRB_FN_CALL_GRAPH_H
+
+#include "gtirb_functions.hpp"
+#include <gtirb/CFG.hpp>
+#include <boost/range.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gtirb {
+
+/// \class CallGraph<T> is the call graph of a set of functions.
+///
+/// Nodes are the functions, identified by their position in the vector the
+/// graph was built from, plus two explicit nodes for call sites whose target
+/// is not a function:
+///
+/// - indirect_node(), the target of indirect call edges to a node outside
+///   every function, typically the proxy block of an unresolved indirect
+///   call.
+///
+/// - unresolved_node(), the target of other calls to a node outside every
+///   function, such as a direct call to a proxy block for an import.
+///
+/// A call to a block that is an entry of one or more functions calls those
+/// functions; a call into the middle of a function calls the functions
+/// containing the block. A call site in a block shared by several functions
+/// is a call from each of them. Only EdgeType::Call edges are considered;
+/// tail calls are reported by Function::tagged_exit_blocks().
+///
+/// Callees and callers are stored in compressed sparse row form. Each entry
+/// records the node at the other end and the block holding the call, so a
+/// function's calls are one contiguous array, sorted by callee and then by
+/// call site UUID. Construction gives the same graph for any thread count.
+template <class ModuleType> class CallGraph {
+public:
+  using FunctionType = Function<ModuleType>;
+  using CodeBlockType = typename FunctionType::CodeBlockType;
+
+  /// \brief The index of a node
+  using node_type = uint32_t;
+
+  /// \brief One call, seen from one of its ends
+  struct Call {
+    /// \brief The callee, in callees(), or the caller, in callers()
+    node_type Node;
+
+    /// \brief The block making the call
+    CodeBlockType* Site;
+  };
+
+  /// \brief Range of calls
+  using call_range = ::boost::iterator_range<const Call*>;
+
+  /// \brief Build the call graph of \p Fns on up to \p NumThreads threads
+  /// (zero means one per hardware thread)
+  explicit CallGraph(const std::vector<FunctionType>& Fns,
+                     unsigned NumThreads = 1)
+      : NumFunctions(static_cast<node_type>(Fns.size())) {
+    if (NumThreads == 0) {
+      NumThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    OwnerMap Entries;
+    OwnerMap Containing;
+    for (size_t I = 0; I < Fns.size(); ++I) {
+      for (const CodeBlock* Block : Fns[I].entry_blocks()) {
+        Entries.add(Block, static_cast<node_type>(I));
+      }
+      for (const CodeBlock* Block : Fns[I].all_blocks()) {
+        Containing.add(Block, static_cast<node_type>(I));
+      }
+    }
+    Entries.finish();
+    Containing.finish();
+
+    // Collect every function's calls independently, then lay them out.
+    std::vector<std::vector<Call>> CallsByFn(Fns.size());
+    detail::parallel_for(Fns.size(), 16, NumThreads, [&](size_t I) {
+      CallsByFn[I] = collectCalls(Fns[I], Entries, Containing);
+    });
+
+    CalleeOffsets.reserve(num_nodes() + 1);
+    CalleeOffsets.push_back(0);
+    for (auto& FnCalls : CallsByFn) {
+      Callees.insert(Callees.end(), FnCalls.begin(), FnCalls.end());
+      CalleeOffsets.push_back(static_cast<uint32_t>(Callees.size()));
+      std::vector<Call>().swap(FnCalls);
+    }
+    // The explicit nodes make no calls
+    CalleeOffsets.push_back(CalleeOffsets.back());
+    CalleeOffsets.push_back(CalleeOffsets.back());
+
+    // Callers, by transposing the callee arrays. Callers of a node come out
+    // sorted by caller, then call site.
+    CallerOffsets.assign(num_nodes() + 1, 0);
+    for (const Call& C : Callees) {
+      ++CallerOffsets[C.Node + 1];
+    }
+    for (size_t I = 1; I < CallerOffsets.size(); ++I) {
+      CallerOffsets[I] += CallerOffsets[I - 1];
+    }
+    Callers.resize(Callees.size());
+    std::vector<uint32_t> Fill(CallerOffsets.begin(), CallerOffsets.end() - 1);
+    for (node_type F = 0; F < NumFunctions; ++F) {
+      for (uint32_t E = CalleeOffsets[F]; E < CalleeOffsets[F + 1]; ++E) {
+        Callers[Fill[Callees[E].Node]++] = Call{F, Callees[E].Site};
+      }
+    }
+  }
+
+  /// \brief Return the number of functions
+  size_t num_functions() const { return NumFunctions; }
+
+  /// \brief Return the number of nodes, including the two explicit ones
+  size_t num_nodes() const { return NumFunctions + 2; }
+
+  /// \brief Return the number of calls
+  size_t num_calls() const { return Callees.size(); }
+
+  /// \brief Return the node standing for unresolved indirect call targets
+  node_type indirect_node() const { return NumFunctions; }
+
+  /// \brief Return the node standing for other call targets outside every
+  /// function
+  node_type unresolved_node() const { return NumFunctions + 1; }
+
+  /// \brief Return whether \p N is a function, rather than an explicit node
+  bool is_function(node_type N) const { return N < NumFunctions; }
+
+  /// \brief Return the calls made by \p N
+  call_range callees(node_type N) const {
+    return {Callees.data() + CalleeOffsets[N],
+            Callees.data() + CalleeOffsets[N + 1]};
+  }
+
+  /// \brief Return the calls made to \p N
+  call_range callers(node_type N) const {
+    return {Callers.data() + CallerOffsets[N],
+            Callers.data() + CallerOffsets[N + 1]};
+  }
+
+private:
+  /// \brief Maps blocks to runs of function indices
+  class OwnerMap {
+  public:
+    void add(const CfgNode* Block, node_type Fn) {
+      Memberships.emplace_back(Block, Fn);
+    }
+
+    void finish() {
+      std::sort(Memberships.begin(), Memberships.end());
+      Owners.reserve(Memberships.size());
+      for (const auto& [Block, Fn] : Memberships) {
+        auto [It, Inserted] = Spans.try_emplace(
+            Block, static_cast<uint32_t>(Owners.size()), 0);
+        (void)Inserted;
+        Owners.push_back(Fn);
+        ++It->second.second;
+      }
+      std::vector<std::pair<const CfgNode*, node_type>>().swap(Memberships);
+    }
+
+    ::boost::iterator_range<const node_type*> owners(const CfgNode* N) const {
+      auto It = Spans.find(N);
+      if (It == Spans.end()) {
+        return {};
+      }
+      const node_type* First = Owners.data() + It->second.first;
+      return {First, First + It->second.second};
+    }
+
+  private:
+    std::vector<std::pair<const CfgNode*, node_type>> Memberships;
+    std::vector<node_type> Owners;
+    std::unordered_map<const CfgNode*, std::pair<uint32_t, uint32_t>> Spans;
+  };
+
+  std::vector<Call> collectCalls(const FunctionType& Fn,
+                                 const OwnerMap& Entries,
+                                 const OwnerMap& Containing) const {
+    std::vector<Call> Calls;
+    const IR* Ir = Fn.Data->Mod->getIR();
+    if (!Ir) {
+      return Calls;
+    }
+    const CFG& Cfg = Ir->getCFG();
+    for (CodeBlockType* Site : Fn.all_blocks()) {
+      for (auto SuccPair : cfgSuccessors(Cfg, Site)) {
+        auto [Target, Label] = SuccPair;
+        if (!Label || std::get<EdgeType>(*Label) != EdgeType::Call) {
+          continue;
+        }
+        auto Targets = Entries.owners(Target);
+        if (Targets.empty()) {
+          Targets = Containing.owners(Target);
+        }
+        if (!Targets.empty()) {
+          for (node_type Callee : Targets) {
+            Calls.push_back({Callee, Site});
+          }
+        } else if (std::get<DirectEdge>(*Label) == DirectEdge::IsIndirect) {
+          Calls.push_back({indirect_node(), Site});
+        } else {
+          Calls.push_back({unresolved_node(), Site});
+        }
+      }
+    }
+    auto Key = [](const Call& C) {
+      return std::make_tuple(C.Node, C.Site->getUUID());
+    };
+    std::sort(Calls.begin(), Calls.end(), [&](const Call& A, const Call& B) {
+      return Key(A) < Key(B);
+    });
+    Calls.erase(std::unique(Calls.begin(), Calls.end(),
+                            [](const Call& A, const Call& B) {
+                              return A.Node == B.Node && A.Site == B.Site;
+                            }),
+                Calls.end());
+    return Calls;
+  }
+
+  node_type NumFunctions;
+
+  std::vector<uint32_t> CalleeOffsets;
+  std::vector<Call> Callees;
+
+  std::vector<uint32_t> CallerOffsets;
+  std::vector<Call> Callers;
+};
+
+} // namespace gtirb
+
+#endif // GTIRB_FN_CALL_GRAPH_H
@@ -0,0 +1,44 @@
+//===- export.hpp -----------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_FN_EXPORT_H
+#define GTIRB_FN_EXPORT_H
+
+/// \def GTIRB_FUNCTIONS_EXPORT marks the declarations compiled into the
+/// gtirb-functions library.
+///
+/// The library build defines GTIRB_FUNCTIONS_EXPORTS, and a static library
+/// build GTIRB_FUNCTIONS_STATIC for its users too; the CMake target sets
+/// both as needed.
+///
+/// \def GTIRB_FUNCTIONS_EXPORT_INSTANTIATION marks the explicit
+/// instantiation definitions in the library. Only DLLs need it: elsewhere the
+/// visibility of the extern template declaration carries over.
+#if defined(_WIN32) || defined(__CYGWIN__)
+#if defined(GTIRB_FUNCTIONS_STATIC)
+#define GTIRB_FUNCTIONS_EXPORT
+#define GTIRB_FUNCTIONS_EXPORT_INSTANTIATION
+#elif defined(GTIRB_FUNCTIONS_EXPORTS)
+#define GTIRB_FUNCTIONS_EXPORT __declspec(dllexport)
+#define GTIRB_FUNCTIONS_EXPORT_INSTANTIATION __declspec(dllexport)
+#else
+#define GTIRB_FUNCTIONS_EXPORT __declspec(dllimport)
+#define GTIRB_FUNCTIONS_EXPORT_INSTANTIATION
+#endif
+#else
+#define GTIRB_FUNCTIONS_EXPORT __attribute__((visibility("default")))
+#define GTIRB_FUNCTIONS_EXPORT_INSTANTIATION
+#endif
+
+#endif // GTIRB_FN_EXPORT_H
@@ -0,0 +1,605 @@
+//===- function_cache.hpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_FN_CACHE_H
+#define GTIRB_FN_CACHE_H
+
+#include "gtirb_functions.hpp"
+#include <boost/functional/hash.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/iterator/transform_iterator.hpp>
+#include <boost/range.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace gtirb {
+
+namespace detail {
+
+/// \brief The on-disk layout of a \ref FunctionCache file
+///
+/// A header is followed by sections, each starting on a 16 byte boundary:
+/// the UUID table, the function records, one array of UUID table indices for
+/// all entry, block and name symbol runs, the exit blocks as UUID table
+/// indices, their ExitKind bits, and the long names. Integers are stored in
+/// the byte order of the writer; files from a machine with the other byte
+/// order are rejected.
+namespace cache_format {
+
+constexpr char Magic[8] = {'G', 'T', 'F', 'N', 'C', 'A', 'C', 'H'};
+constexpr uint32_t Version = 1;
+constexpr uint32_t ByteOrderMark = 0x01020304;
+constexpr uint32_t NoIndex = UINT32_MAX;
+
+struct Header {
+  char Magic[8];
+  uint32_t Version;
+  uint32_t ByteOrder;
+  uint64_t Key;
+  uint64_t FileSize;
+  uint32_t NumFunctions;
+  uint32_t NumUuids;
+  uint32_t NumIndices;
+  uint32_t NumExits;
+  uint64_t NameBytes;
+  uint64_t UuidOffset;
+  uint64_t FunctionOffset;
+  uint64_t IndexOffset;
+  uint64_t ExitOffset;
+  uint64_t KindOffset;
+  uint64_t NameOffset;
+};
+
+struct Run {
+  uint32_t Offset;
+  uint32_t Count;
+};
+
+struct FunctionRecord {
+  uint32_t Uuid;
+  uint32_t CanonName;
+  Run Entries;
+  Run Blocks;
+  Run Names;
+  Run Exits;
+  uint64_t LongNameOffset;
+  uint32_t LongNameSize;
+  uint32_t Flags;
+};
+
+/// \brief FunctionRecord::Flags bit for functions built with
+/// ExitBlockMode::Skip
+constexpr uint32_t SkipExits = 1;
+
+inline uint64_t align(uint64_t Offset) { return (Offset + 15) & ~uint64_t(15); }
+
+} // namespace cache_format
+
+/// \brief The 64-bit FNV-1a hash of a sequence of bytes
+struct Fnv1a {
+  uint64_t Value = 0xcbf29ce484222325ull;
+
+  void mix(const void* Bytes, size_t Size) {
+    auto* P = static_cast<const unsigned char*>(Bytes);
+    for (size_t I = 0; I < Size; ++I) {
+      Value = (Value ^ P[I]) * 0x100000001b3ull;
+    }
+  }
+};
+
+} // namespace detail
+
+/// \class FunctionCache is a memory-mapped, read-only copy of the functions
+/// of a module, saved in a sidecar file.
+///
+/// write() saves functions built by \ref build_functions, together with a key
+/// identifying the module they came from. open() maps such a file back into
+/// memory if its key matches. Nothing is parsed or copied: the accessors read
+/// the mapped file directly, so a cache can be queried without loading the
+/// IR at all. functions() turns the cache back into Function objects,
+/// resolving each UUID once and skipping the CFG walk for exit blocks.
+///
+/// Blocks, symbols and functions are stored as UUIDs, through a table of the
+/// distinct UUIDs the file refers to.
+class FunctionCache {
+public:
+  /// \brief Iterator over UUIDs stored in the cache
+  using uuid_iterator = ::boost::transform_iterator<
+      std::function<const UUID&(uint32_t)>, const uint32_t*>;
+
+  /// \brief Range of UUIDs stored in the cache
+  using uuid_range = ::boost::iterator_range<uuid_iterator>;
+
+  /// \brief Range of ExitKind bits, parallel to exit_blocks()
+  using kind_range = ::boost::iterator_range<const uint8_t*>;
+
+  /// \brief Compute a cache key from everything the functions of \p M are
+  /// built from
+  ///
+  /// That is the function AuxData, the CFG edges out of the module's code
+  /// blocks, and the name and referent of each of its symbols. Edges and
+  /// symbols are hashed in any order, so the key of a module does not change
+  /// when it is saved and loaded again. \p Salt is mixed in, for callers that
+  /// want to tie the cache to something else as well, such as the version of
+  /// the tool that wrote it.
+  static uint64_t key(const Module& M, uint64_t Salt = 0) {
+    detail::Fnv1a Hash;
+    auto mixUuids = [&](const auto* Table) {
+      uint64_t Size = Table ? Table->size() : UINT64_MAX;
+      Hash.mix(&Size, sizeof(Size));
+      if (!Table) {
+        return;
+      }
+      for (const auto& [FnId, Ids] : *Table) {
+        Hash.mix(FnId.data, sizeof(FnId.data));
+        uint64_t Count = Ids.size();
+        Hash.mix(&Count, sizeof(Count));
+        for (const UUID& Id : Ids) {
+          Hash.mix(Id.data, sizeof(Id.data));
+        }
+      }
+    };
+    Hash.mix(&Salt, sizeof(Salt));
+    mixUuids(M.getAuxData<schema::FunctionEntries>());
+    mixUuids(M.getAuxData<schema::FunctionBlocks>());
+    auto* Names = M.getAuxData<schema::FunctionNames>();
+    uint64_t Size = Names ? Names->size() : UINT64_MAX;
+    Hash.mix(&Size, sizeof(Size));
+    if (Names) {
+      for (const auto& [FnId, NameId] : *Names) {
+        Hash.mix(FnId.data, sizeof(FnId.data));
+        Hash.mix(NameId.data, sizeof(NameId.data));
+      }
+    }
+
+    // The edges and symbols, each hashed on its own and summed
+    uint64_t Edges = 0;
+    if (const IR* Ir = M.getIR()) {
+      const CFG& Cfg = Ir->getCFG();
+      for (const CodeBlock& Block : M.code_blocks()) {
+        for (const auto& [Succ, Label] : cfgSuccessors(Cfg, &Block)) {
+          detail::Fnv1a Edge;
+          Edge.mix(Block.getUUID().data, sizeof(UUID));
+          Edge.mix(Succ->getUUID().data, sizeof(UUID));
+          uint8_t Kind[4] = {isa<CodeBlock>(Succ), 0, 0, 0};
+          if (Label) {
+            auto [Cond, Direct, Type] = *Label;
+            Kind[1] = 1 + static_cast<uint8_t>(Cond);
+            Kind[2] = 1 + static_cast<uint8_t>(Direct);
+            Kind[3] = 1 + static_cast<uint8_t>(Type);
+          }
+          Edge.mix(Kind, sizeof(Kind));
+          Edges += Edge.Value;
+        }
+      }
+    }
+    uint64_t Symbols = 0;
+    for (const Symbol& Sym : M.symbols()) {
+      detail::Fnv1a One;
+      const std::string& Name = Sym.getName();
+      One.mix(Name.data(), Name.size());
+      if (const Node* Referent = Sym.getReferent<Node>()) {
+        One.mix(Referent->getUUID().data, sizeof(UUID));
+      }
+      Symbols += One.Value;
+    }
+    Hash.mix(&Edges, sizeof(Edges));
+    Hash.mix(&Symbols, sizeof(Symbols));
+    return Hash.Value;
+  }
+
+  /// \brief Save \p Fns to \p Path under \p Key
+  ///
+  /// Exit blocks that were not computed yet are computed first, in one pass.
+  /// The file is written under a unique name next to \p Path and renamed
+  /// into place, so readers never see a partial file.
+  ///
+  /// \return whether the file was written
+  template <class ModuleType>
+  static bool write(const std::string& Path, uint64_t Key,
+                    std::vector<Function<ModuleType>>& Fns) {
+    namespace fmt = detail::cache_format;
+    classify_exits(Fns);
+
+    std::vector<UUID> Uuids;
+    std::unordered_map<UUID, uint32_t, boost::hash<UUID>> UuidIndex;
+    auto indexOf = [&](const UUID& Id) {
+      auto [It, Inserted] =
+          UuidIndex.try_emplace(Id, static_cast<uint32_t>(Uuids.size()));
+      if (Inserted) {
+        Uuids.push_back(Id);
+      }
+      return It->second;
+    };
+    std::vector<fmt::FunctionRecord> Records;
+    std::vector<uint32_t> Indices;
+    std::vector<uint32_t> Exits;
+    std::vector<uint8_t> Kinds;
+    std::string Names;
+    auto appendRun = [&](auto Range) {
+      fmt::Run R{static_cast<uint32_t>(Indices.size()), 0};
+      for (const auto* N : Range) {
+        Indices.push_back(indexOf(N->getUUID()));
+        ++R.Count;
+      }
+      return R;
+    };
+    Records.reserve(Fns.size());
+    for (auto& Fn : Fns) {
+      fmt::FunctionRecord R{};
+      R.Uuid = indexOf(Fn.getUUID());
+      R.CanonName =
+          Fn.getName() ? indexOf(Fn.getName()->getUUID()) : fmt::NoIndex;
+      R.Entries = appendRun(Fn.entry_blocks());
+      R.Blocks = appendRun(Fn.all_blocks());
+      R.Names = appendRun(Fn.name_symbols());
+      R.Exits.Offset = static_cast<uint32_t>(Exits.size());
+      for (const auto& Exit : Fn.tagged_exit_blocks()) {
+        Exits.push_back(indexOf(Exit.Block->getUUID()));
+        Kinds.push_back(Exit.Kinds);
+        ++R.Exits.Count;
+      }
+      std::string_view LongName = Fn.getLongNameView();
+      R.LongNameOffset = Names.size();
+      R.LongNameSize = static_cast<uint32_t>(LongName.size());
+      Names += LongName;
+      R.Flags = Fn.Data->SkipExitBlocks ? fmt::SkipExits : 0;
+      Records.push_back(R);
+    }
+
+    fmt::Header H{};
+    std::memcpy(H.Magic, fmt::Magic, sizeof(H.Magic));
+    H.Version = fmt::Version;
+    H.ByteOrder = fmt::ByteOrderMark;
+    H.Key = Key;
+    H.NumFunctions = static_cast<uint32_t>(Records.size());
+    H.NumUuids = static_cast<uint32_t>(Uuids.size());
+    H.NumIndices = static_cast<uint32_t>(Indices.size());
+    H.NumExits = static_cast<uint32_t>(Exits.size());
+    H.NameBytes = Names.size();
+    H.UuidOffset = fmt::align(sizeof(H));
+    H.FunctionOffset = fmt::align(H.UuidOffset + Uuids.size() * sizeof(UUID));
+    H.IndexOffset = fmt::align(H.FunctionOffset +
+                               Records.size() * sizeof(fmt::FunctionRecord));
+    H.ExitOffset =
+        fmt::align(H.IndexOffset + Indices.size() * sizeof(uint32_t));
+    H.KindOffset = fmt::align(H.ExitOffset + Exits.size() * sizeof(uint32_t));
+    H.NameOffset = fmt::align(H.KindOffset + Kinds.size());
+    H.FileSize = H.NameOffset + Names.size();
+
+    // A name of its own, so that concurrent writers of the same cache do not
+    // clobber each other's file before renaming it
+    std::random_device Random;
+    std::string TmpPath = Path + ".tmp." + std::to_string(Random()) +
+                          std::to_string(Random());
+    {
+      std::ofstream Out(TmpPath, std::ios::binary | std::ios::trunc);
+      auto put = [&Out](uint64_t Offset, const void* Bytes, size_t Size) {
+        Out.seekp(static_cast<std::streamoff>(Offset));
+        Out.write(static_cast<const char*>(Bytes),
+                  static_cast<std::streamsize>(Size));
+      };
+      put(0, &H, sizeof(H));
+      put(H.UuidOffset, Uuids.data(), Uuids.size() * sizeof(UUID));
+      put(H.FunctionOffset, Records.data(),
+          Records.size() * sizeof(fmt::FunctionRecord));
+      put(H.IndexOffset, Indices.data(), Indices.size() * sizeof(uint32_t));
+      put(H.ExitOffset, Exits.data(), Exits.size() * sizeof(uint32_t));
+      put(H.KindOffset, Kinds.data(), Kinds.size());
+      put(H.NameOffset, Names.data(), Names.size());
+      Out.flush();
+      Out.close();
+      if (!Out) {
+        std::remove(TmpPath.c_str());
+        return false;
+      }
+    }
+#ifdef _WIN32
+    // rename() does not replace an existing file on Windows
+    std::remove(Path.c_str());
+#endif
+    if (std::rename(TmpPath.c_str(), Path.c_str()) != 0) {
+      std::remove(TmpPath.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  /// \brief Map the cache at \p Path, if it exists, is well formed and was
+  /// written under \p Key
+  static std::optional<FunctionCache> open(const std::string& Path,
+                                           uint64_t Key) {
+    namespace ipc = ::boost::interprocess;
+    std::shared_ptr<ipc::mapped_region> Region;
+    try {
+      ipc::file_mapping File(Path.c_str(), ipc::read_only);
+      Region = std::make_shared<ipc::mapped_region>(File, ipc::read_only);
+    } catch (const ipc::interprocess_exception&) {
+      return std::nullopt;
+    }
+    FunctionCache Cache(std::move(Region));
+    if (!Cache.valid(Key)) {
+      return std::nullopt;
+    }
+    return Cache;
+  }
+
+  /// \brief Return the number of functions
+  size_t size() const { return header().NumFunctions; }
+
+  /// \brief Return the UUID of function \p I
+  const UUID& uuid(size_t I) const { return uuids()[record(I).Uuid]; }
+
+  /// \brief Return the UUIDs of the entry blocks of function \p I
+  uuid_range entry_blocks(size_t I) const { return run(record(I).Entries); }
+
+  /// \brief Return the UUIDs of the blocks of function \p I
+  uuid_range all_blocks(size_t I) const { return run(record(I).Blocks); }
+
+  /// \brief Return the UUIDs of the name symbols of function \p I
+  uuid_range name_symbols(size_t I) const { return run(record(I).Names); }
+
+  /// \brief Return the UUIDs of the exit blocks of function \p I
+  uuid_range exit_blocks(size_t I) const {
+    const auto& R = record(I).Exits;
+    const uint32_t* First = exits() + R.Offset;
+    return {uuid_iterator(First, lookup()),
+            uuid_iterator(First + R.Count, lookup())};
+  }
+
+  /// \brief Return the ExitKind bits of the exit blocks of function \p I
+  kind_range exit_kinds(size_t I) const {
+    const auto& R = record(I).Exits;
+    return {kinds() + R.Offset, kinds() + R.Offset + R.Count};
+  }
+
+  /// \brief Return the UUID of the AuxData name of function \p I, if any
+  std::optional<UUID> name(size_t I) const {
+    uint32_t Id = record(I).CanonName;
+    if (Id == detail::cache_format::NoIndex) {
+      return std::nullopt;
+    }
+    return uuids()[Id];
+  }
+
+  /// \brief Return the long name of function \p I
+  std::string_view long_name(size_t I) const {
+    const auto& R = record(I);
+    return {names() + R.LongNameOffset, R.LongNameSize};
+  }
+
+  /// \brief Rebuild the Functions of \p M from the cache
+  ///
+  /// \return the functions, in the order they were written, or nothing if a
+  /// UUID in the cache does not resolve in \p C
+  template <class ContextType, class ModuleType>
+  std::optional<std::vector<Function<ModuleType>>>
+  functions(ContextType& C, ModuleType& M) const {
+    const auto& H = header();
+    std::vector<const Node*> Nodes(H.NumUuids);
+    for (uint32_t I = 0; I < H.NumUuids; ++I) {
+      Nodes[I] = Node::getByUUID(C, uuids()[I]);
+    }
+    return Function<ModuleType>::from_cache(*this, Nodes, M);
+  }
+
+private:
+  template <class ModuleType> friend class Function;
+
+  using RegionPtr = std::shared_ptr<::boost::interprocess::mapped_region>;
+
+  explicit FunctionCache(RegionPtr R)
+      : Region(std::move(R)),
+        Base(static_cast<const char*>(Region->get_address())),
+        Size(Region->get_size()) {}
+
+  bool valid(uint64_t Key) const {
+    namespace fmt = detail::cache_format;
+    if (Size < sizeof(fmt::Header)) {
+      return false;
+    }
+    const auto& H = header();
+    if (std::memcmp(H.Magic, fmt::Magic, sizeof(H.Magic)) != 0 ||
+        H.Version != fmt::Version || H.ByteOrder != fmt::ByteOrderMark ||
+        H.Key != Key || H.FileSize != Size) {
+      return false;
+    }
+    auto fits = [this](uint64_t Offset, uint64_t Bytes) {
+      return Offset <= Size && Bytes <= Size - Offset;
+    };
+    if (!fits(H.UuidOffset, uint64_t(H.NumUuids) * sizeof(UUID)) ||
+        !fits(H.FunctionOffset,
+              uint64_t(H.NumFunctions) * sizeof(fmt::FunctionRecord)) ||
+        !fits(H.IndexOffset, uint64_t(H.NumIndices) * sizeof(uint32_t)) ||
+        !fits(H.ExitOffset, uint64_t(H.NumExits) * sizeof(uint32_t)) ||
+        !fits(H.KindOffset, H.NumExits) || !fits(H.NameOffset, H.NameBytes)) {
+      return false;
+    }
+    auto runFits = [](fmt::Run R, uint32_t Limit) {
+      return R.Offset <= Limit && R.Count <= Limit - R.Offset;
+    };
+    auto indicesValid = [&](fmt::Run R, const uint32_t* Array) {
+      for (uint32_t I = R.Offset; I < R.Offset + R.Count; ++I) {
+        if (Array[I] >= H.NumUuids) {
+          return false;
+        }
+      }
+      return true;
+    };
+    for (size_t I = 0; I < H.NumFunctions; ++I) {
+      const auto& R = record(I);
+      if (R.Uuid >= H.NumUuids ||
+          (R.CanonName != fmt::NoIndex && R.CanonName >= H.NumUuids) ||
+          !runFits(R.Entries, H.NumIndices) ||
+          !runFits(R.Blocks, H.NumIndices) ||
+          !runFits(R.Names, H.NumIndices) || !runFits(R.Exits, H.NumExits) ||
+          R.LongNameOffset > H.NameBytes ||
+          R.LongNameSize > H.NameBytes - R.LongNameOffset ||
+          !indicesValid(R.Entries, indices()) ||
+          !indicesValid(R.Blocks, indices()) ||
+          !indicesValid(R.Names, indices()) ||
+          !indicesValid(R.Exits, exits())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const detail::cache_format::Header& header() const {
+    return *reinterpret_cast<const detail::cache_format::Header*>(Base);
+  }
+
+  const detail::cache_format::FunctionRecord& record(size_t I) const {
+    return reinterpret_cast<const detail::cache_format::FunctionRecord*>(
+        Base + header().FunctionOffset)[I];
+  }
+
+  const UUID* uuids() const {
+    return reinterpret_cast<const UUID*>(Base + header().UuidOffset);
+  }
+
+  const uint32_t* indices() const {
+    return reinterpret_cast<const uint32_t*>(Base + header().IndexOffset);
+  }
+
+  const uint32_t* exits() const {
+    return reinterpret_cast<const uint32_t*>(Base + header().ExitOffset);
+  }
+
+  const uint8_t* kinds() const {
+    return reinterpret_cast<const uint8_t*>(Base + header().KindOffset);
+  }
+
+  const char* names() const { return Base + header().NameOffset; }
+
+  std::function<const UUID&(uint32_t)> lookup() const {
+    const UUID* Table = uuids();
+    return [Table](uint32_t I) -> const UUID& { return Table[I]; };
+  }
+
+  uuid_range run(detail::cache_format::Run R) const {
+    const uint32_t* First = indices() + R.Offset;
+    return {uuid_iterator(First, lookup()),
+            uuid_iterator(First + R.Count, lookup())};
+  }
+
+  RegionPtr Region;
+  const char* Base;
+  size_t Size;
+};
+
+template <class ModuleType>
+std::optional<std::vector<Function<ModuleType>>>
+Function<ModuleType>::from_cache(const FunctionCache& Cache,
+                                 const std::vector<const Node*>& Nodes,
+                                 ModuleType& Mod) {
+  namespace fmt = detail::cache_format;
+  auto block = [&Nodes](uint32_t I) {
+    return dyn_cast_or_null<CodeBlock>(Nodes[I]);
+  };
+  auto symbol = [&Nodes](uint32_t I) {
+    return dyn_cast_or_null<Symbol>(Nodes[I]);
+  };
+
+  std::vector<Function<ModuleType>> Fns;
+  Fns.reserve(Cache.size());
+  for (size_t I = 0; I < Cache.size(); ++I) {
+    const fmt::FunctionRecord& R = Cache.record(I);
+    auto D = std::make_shared<detail::FunctionData>();
+    D->Uuid = Cache.uuids()[R.Uuid];
+    D->Mod = &Mod;
+    D->SkipExitBlocks = R.Flags & fmt::SkipExits;
+
+    auto fill = [&](fmt::Run Run, auto& Set, auto resolve) {
+      Set.reserve(Run.Count);
+      const uint32_t* Ids = Cache.indices() + Run.Offset;
+      for (uint32_t J = 0; J < Run.Count; ++J) {
+        auto* N = resolve(Ids[J]);
+        if (!N) {
+          return false;
+        }
+        Set.insert(N);
+      }
+      return true;
+    };
+    if (!fill(R.Entries, D->EntryBlocks, block) ||
+        !fill(R.Blocks, D->AllBlocks, block) ||
+        !fill(R.Names, D->NameSymbols, symbol)) {
+      return std::nullopt;
+    }
+    if (R.CanonName != fmt::NoIndex) {
+      if (!(D->CanonName = symbol(R.CanonName))) {
+        return std::nullopt;
+      }
+    }
+
+    if (!D->SkipExitBlocks) {
+      std::vector<TaggedExitBlock<const CodeBlock>> Tagged;
+      Tagged.reserve(R.Exits.Count);
+      for (uint32_t J = R.Exits.Offset; J < R.Exits.Offset + R.Exits.Count;
+           ++J) {
+        const CodeBlock* Block = block(Cache.exits()[J]);
+        if (!Block) {
+          return std::nullopt;
+        }
+        Tagged.push_back({Block, Cache.kinds()[J]});
+      }
+      D->Exits.set(makeExitBlockInfo(std::move(Tagged)));
+    }
+    if (D->NameSymbols.size() > 1) {
+      D->LongName.set(std::string(Cache.long_name(I)));
+    }
+    Fns.push_back(Function{std::move(D)});
+  }
+  return Fns;
+}
+
+/// \brief Build the functions of \p M, going through the sidecar cache at
+/// \p Path
+///
+/// If \p Path holds a cache for the current state of \p M (and \p Salt, see
+/// FunctionCache::key()), the functions are restored from it and nothing is
+/// rebuilt. Otherwise they are built with \p Opts, and the cache is
+/// rewritten. Exit blocks are always computed, in one pass, so that they can
+/// be saved.
+template <class ContextType, class ModuleType>
+std::vector<Function<ModuleType>>
+build_functions_cached(ContextType& C, ModuleType& M, const std::string& Path,
+                       const FunctionBuildOptions& Opts = {},
+                       uint64_t Salt = 0) {
+  uint64_t Key = FunctionCache::key(M, Salt);
+  if (auto Cache = FunctionCache::open(Path, Key)) {
+    if (auto Fns = Cache->functions(C, M)) {
+      return std::move(*Fns);
+    }
+  }
+  std::vector<Function<ModuleType>> Fns = build_functions(C, M, Opts);
+  FunctionCache::write(Path, Key, Fns);
+  return Fns;
+}
+
+} // namespace gtirb
+
+#endif // GTIRB_FN_CACHE_H
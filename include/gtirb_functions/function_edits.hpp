@@ -0,0 +1,145 @@
+//===- function_edits.hpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_FN_EDITS_H
+#define GTIRB_FN_EDITS_H
+
+#include "gtirb_functions.hpp"
+#include <gtirb/AuxDataSchema.hpp>
+#include <gtirb/Module.hpp>
+#include <map>
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace gtirb {
+
+/// \class FunctionEdits collects edited functions of a module and writes
+/// them to the module's function AuxData in one batch.
+///
+/// Staged functions are snapshots: edits made to a Function after it is
+/// staged are not committed unless it is staged again. Staging a function, or
+/// removing it, replaces whatever was staged for it before.
+///
+/// commit() only touches the AuxData entries of the staged functions, instead
+/// of rebuilding the FunctionEntries, FunctionBlocks and FunctionNames tables.
+/// It is transactional: everything that can fail, such as allocating the new
+/// UUID sets and map nodes, is done before any existing entry is modified. If
+/// commit() throws, the AuxData entries and the staged edits are unchanged.
+class FunctionEdits {
+public:
+  /// \brief Prepare to edit the functions of \p M
+  explicit FunctionEdits(Module& M) : Mod(M) {}
+
+  /// \brief Stage the current contents of \p Fn
+  void update(const Function<Module>& Fn) {
+    Pending.insert_or_assign(Fn.getUUID(), Fn);
+  }
+
+  /// \brief Stage the removal of function \p FnId
+  void remove(const UUID& FnId) {
+    Pending.insert_or_assign(FnId, std::nullopt);
+  }
+
+  /// \brief Return the number of functions with staged edits
+  size_t size() const { return Pending.size(); }
+
+  /// \brief Return whether no edits are staged
+  bool empty() const { return Pending.empty(); }
+
+  /// \brief Discard the staged edits
+  void clear() { Pending.clear(); }
+
+  /// \brief Write the staged edits to the module's AuxData, creating the
+  /// tables if needed, and clear them
+  void commit() {
+    using EntriesType = schema::FunctionEntries::Type;
+    using BlocksType = schema::FunctionBlocks::Type;
+    using NamesType = schema::FunctionNames::Type;
+
+    // Prepare: build every new entry as a detached map node.
+    EntriesType NewEntries;
+    BlocksType NewBlocks;
+    NamesType NewNames;
+    std::vector<typename EntriesType::node_type> EntryNodes;
+    std::vector<typename BlocksType::node_type> BlockNodes;
+    std::vector<typename NamesType::node_type> NameNodes;
+    EntryNodes.reserve(Pending.size());
+    BlockNodes.reserve(Pending.size());
+    NameNodes.reserve(Pending.size());
+    for (const auto& [FnId, Fn] : Pending) {
+      if (!Fn) {
+        continue;
+      }
+      EntryNodes.push_back(
+          detach(NewEntries, FnId, uuids(Fn->entry_blocks())));
+      BlockNodes.push_back(detach(NewBlocks, FnId, uuids(Fn->all_blocks())));
+      if (const Symbol* Name = Fn->getName()) {
+        NameNodes.push_back(detach(NewNames, FnId, Name->getUUID()));
+      }
+    }
+    EntriesType* Entries = table<schema::FunctionEntries>();
+    BlocksType* Blocks = table<schema::FunctionBlocks>();
+    NamesType* Names = table<schema::FunctionNames>();
+
+    // Apply: erasing and inserting detached nodes does not allocate.
+    for (const auto& Edit : Pending) {
+      Entries->erase(Edit.first);
+      Blocks->erase(Edit.first);
+      Names->erase(Edit.first);
+    }
+    for (auto& Node : EntryNodes) {
+      Entries->insert(std::move(Node));
+    }
+    for (auto& Node : BlockNodes) {
+      Blocks->insert(std::move(Node));
+    }
+    for (auto& Node : NameNodes) {
+      Names->insert(std::move(Node));
+    }
+    Pending.clear();
+  }
+
+private:
+  template <class RangeType> static std::set<UUID> uuids(RangeType Blocks) {
+    std::set<UUID> Ids;
+    for (const CodeBlock* Block : Blocks) {
+      Ids.insert(Block->getUUID());
+    }
+    return Ids;
+  }
+
+  template <class MapType, class ValueType>
+  static typename MapType::node_type detach(MapType& Staging, const UUID& Key,
+                                            ValueType&& Value) {
+    auto It = Staging.emplace(Key, std::forward<ValueType>(Value)).first;
+    return Staging.extract(It);
+  }
+
+  /// \brief Return the AuxData table \p Schema, creating it if needed
+  template <class Schema> typename Schema::Type* table() {
+    if (!Mod.getAuxData<Schema>()) {
+      Mod.addAuxData<Schema>(typename Schema::Type());
+    }
+    return Mod.getAuxData<Schema>();
+  }
+
+  Module& Mod;
+  std::map<UUID, std::optional<Function<Module>>> Pending;
+};
+
+} // namespace gtirb
+
+#endif // GTIRB_FN_EDITS_H
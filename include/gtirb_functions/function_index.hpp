@@ -0,0 +1,234 @@
+//===- function_index.hpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_FN_INDEX_H
+#define GTIRB_FN_INDEX_H
+
+#include "gtirb_functions.hpp"
+#include <gtirb/Addr.hpp>
+#include <gtirb/CodeBlock.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/range.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gtirb {
+
+/// \class FunctionIndex<T> maps code blocks and addresses back to the
+/// functions that contain them.
+///
+/// Functions are identified by their position in the vector the index was
+/// built from, so that vector must not be reordered while the index is in use.
+/// A block that belongs to several functions reports all of them, in
+/// increasing index order.
+///
+/// Lookups by block or block UUID are hash lookups. Lookups by address use a
+/// sorted list of non-overlapping address segments, each labelled with the
+/// functions whose blocks cover it, and run in O(log n) plus the size of the
+/// answer.
+template <class ModuleType> class FunctionIndex {
+public:
+  using FunctionType = Function<ModuleType>;
+
+  /// \brief Iterator over the indices of the functions matching a query
+  using index_iterator = const size_t*;
+
+  /// \brief Range of indices of the functions matching a query
+  using index_range = ::boost::iterator_range<index_iterator>;
+
+  /// \brief Build an index over \p Fns
+  ///
+  /// Block addresses are read once, here; blocks without an address or with
+  /// a size of zero are only found by block or UUID.
+  explicit FunctionIndex(const std::vector<FunctionType>& Fns) {
+    std::vector<std::pair<const CodeBlock*, size_t>> Memberships;
+    for (size_t I = 0; I < Fns.size(); ++I) {
+      for (const CodeBlock* Block : Fns[I].all_blocks()) {
+        Memberships.emplace_back(Block, I);
+      }
+    }
+    std::sort(Memberships.begin(), Memberships.end());
+    Memberships.erase(std::unique(Memberships.begin(), Memberships.end()),
+                      Memberships.end());
+
+    BlockOwners.reserve(Memberships.size());
+    std::vector<Extent> Extents;
+    for (auto It = Memberships.begin(); It != Memberships.end();) {
+      const CodeBlock* Block = It->first;
+      OwnerSpan Span{static_cast<uint32_t>(BlockOwners.size()), 0};
+      for (; It != Memberships.end() && It->first == Block; ++It) {
+        BlockOwners.push_back(It->second);
+        ++Span.Count;
+      }
+      ByBlock.emplace(Block, Span);
+      ByUUID.emplace(Block->getUUID(), Span);
+
+      std::optional<Addr> Address = Block->getAddress();
+      if (Address && Block->getSize() > 0) {
+        uint64_t Start = static_cast<uint64_t>(*Address);
+        Extents.push_back({Start, Start + Block->getSize(), Span});
+      }
+    }
+    buildSegments(Extents);
+  }
+
+  /// \brief Return the functions that contain \p Block
+  index_range functions(const CodeBlock* Block) const {
+    auto It = ByBlock.find(Block);
+    return It == ByBlock.end() ? index_range() : owners(It->second);
+  }
+
+  /// \brief Return the functions that contain the block with UUID \p Id
+  index_range functions(const UUID& Id) const {
+    auto It = ByUUID.find(Id);
+    return It == ByUUID.end() ? index_range() : owners(It->second);
+  }
+
+  /// \brief Return the functions with a block covering address \p A
+  index_range functions_at(Addr A) const {
+    uint64_t Address = static_cast<uint64_t>(A);
+    auto It = std::upper_bound(
+        Segments.begin(), Segments.end(), Address,
+        [](uint64_t X, const Segment& S) { return X < S.Start; });
+    if (It == Segments.begin() || Address >= std::prev(It)->End) {
+      return index_range();
+    }
+    return segmentOwners(*std::prev(It));
+  }
+
+  /// \brief Return the functions with a block overlapping the address range
+  /// [\p Low, \p High), sorted by index and without duplicates
+  std::vector<size_t> functions_in(Addr Low, Addr High) const {
+    uint64_t Lo = static_cast<uint64_t>(Low);
+    uint64_t Hi = static_cast<uint64_t>(High);
+    std::vector<size_t> Result;
+    auto It = std::partition_point(
+        Segments.begin(), Segments.end(),
+        [Lo](const Segment& S) { return S.End <= Lo; });
+    for (; It != Segments.end() && It->Start < Hi; ++It) {
+      auto Owners = segmentOwners(*It);
+      Result.insert(Result.end(), Owners.begin(), Owners.end());
+    }
+    std::sort(Result.begin(), Result.end());
+    Result.erase(std::unique(Result.begin(), Result.end()), Result.end());
+    return Result;
+  }
+
+private:
+  /// \brief A run of function indices in one of the owner arrays
+  struct OwnerSpan {
+    uint32_t Offset;
+    uint32_t Count;
+  };
+
+  /// \brief The address range of a block, and the functions containing it
+  struct Extent {
+    uint64_t Start;
+    uint64_t End;
+    OwnerSpan Owners;
+  };
+
+  /// \brief A maximal address range covered by the same set of functions
+  struct Segment {
+    uint64_t Start;
+    uint64_t End;
+    OwnerSpan Owners;
+  };
+
+  index_range owners(OwnerSpan Span) const {
+    const size_t* First = BlockOwners.data() + Span.Offset;
+    return {First, First + Span.Count};
+  }
+
+  index_range segmentOwners(const Segment& S) const {
+    const size_t* First = SegmentOwners.data() + S.Owners.Offset;
+    return {First, First + S.Owners.Count};
+  }
+
+  /// \brief Split the (possibly overlapping) block extents into sorted,
+  /// disjoint segments
+  void buildSegments(std::vector<Extent>& Extents) {
+    std::vector<uint64_t> Points;
+    Points.reserve(Extents.size() * 2);
+    for (const auto& E : Extents) {
+      Points.push_back(E.Start);
+      Points.push_back(E.End);
+    }
+    std::sort(Points.begin(), Points.end());
+    Points.erase(std::unique(Points.begin(), Points.end()), Points.end());
+    std::sort(Extents.begin(), Extents.end(),
+              [](const Extent& A, const Extent& B) {
+                return A.Start < B.Start;
+              });
+
+    // Sweep over the boundaries, tracking the extents that are open. Blocks
+    // rarely overlap, so the active set stays tiny.
+    std::vector<const Extent*> Active;
+    std::vector<size_t> Owners;
+    auto Next = Extents.begin();
+    for (size_t P = 0; P + 1 < Points.size(); ++P) {
+      uint64_t Start = Points[P];
+      uint64_t End = Points[P + 1];
+      Active.erase(std::remove_if(Active.begin(), Active.end(),
+                                  [Start](const Extent* E) {
+                                    return E->End <= Start;
+                                  }),
+                   Active.end());
+      for (; Next != Extents.end() && Next->Start == Start; ++Next) {
+        Active.push_back(&*Next);
+      }
+      if (Active.empty()) {
+        continue;
+      }
+
+      Owners.clear();
+      for (const Extent* E : Active) {
+        auto Span = owners(E->Owners);
+        Owners.insert(Owners.end(), Span.begin(), Span.end());
+      }
+      std::sort(Owners.begin(), Owners.end());
+      Owners.erase(std::unique(Owners.begin(), Owners.end()), Owners.end());
+
+      // Extend the previous segment if it is adjacent and owned by the same
+      // functions, e.g. consecutive blocks of one function.
+      if (!Segments.empty() && Segments.back().End == Start) {
+        auto Previous = segmentOwners(Segments.back());
+        if (std::equal(Previous.begin(), Previous.end(), Owners.begin(),
+                       Owners.end())) {
+          Segments.back().End = End;
+          continue;
+        }
+      }
+      Segments.push_back(
+          {Start, End,
+           OwnerSpan{static_cast<uint32_t>(SegmentOwners.size()),
+                     static_cast<uint32_t>(Owners.size())}});
+      SegmentOwners.insert(SegmentOwners.end(), Owners.begin(), Owners.end());
+    }
+  }
+
+  std::vector<size_t> BlockOwners;
+  std::unordered_map<const CodeBlock*, OwnerSpan> ByBlock;
+  std::unordered_map<UUID, OwnerSpan, boost::hash<UUID>> ByUUID;
+
+  std::vector<size_t> SegmentOwners;
+  std::vector<Segment> Segments;
+};
+
+} // namespace gtirb
+
+#endif // GTIRB_FN_INDEX_H
@@ -0,0 +1,180 @@
+//===- function_set.hpp -----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_FN_SET_H
+#define GTIRB_FN_SET_H
+
+#include "gtirb_functions.hpp"
+#include <gtirb/CfgNode.hpp>
+#include <boost/range/adaptor/map.hpp>
+#include <algorithm>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace gtirb {
+
+/// \class FunctionSet<T> keeps the functions of a module up to date as the
+/// module is edited.
+///
+/// The set is built once, like \ref build_functions. After that, passes that
+/// edit the module report what they changed, and only the affected functions
+/// are recomputed:
+///
+/// - function_changed() after adding, removing or editing the
+///   FunctionEntries, FunctionBlocks or FunctionNames entry of a function, or
+///   the symbols referring to its entry blocks. The function's blocks and
+///   names are rebuilt from the AuxData.
+///
+/// - edge_changed() after adding or removing a CFG edge. The exit blocks and
+///   local CFGs of the functions containing the edge's source are recomputed.
+///
+/// Functions handed out earlier are snapshots: they share data with the set
+/// until it changes, and are not updated.
+template <class ModuleType> class FunctionSet {
+public:
+  using FunctionType = Function<ModuleType>;
+  using ContextType =
+      std::conditional_t<std::is_const<ModuleType>::value, const Context,
+                         Context>;
+
+  /// \brief Build the functions of \p M
+  ///
+  /// \p Opts is also used for later rebuilds, except that they are always
+  /// done on the calling thread.
+  FunctionSet(ContextType& C, ModuleType& M,
+              const FunctionBuildOptions& Opts = FunctionBuildOptions())
+      : Ctx(C), Mod(M), Exits(Opts.ExitBlocks) {
+    for (auto& Fn : FunctionType::build_functions(C, M, Opts)) {
+      UUID Id = Fn.getUUID();
+      addOwners(Fn);
+      Functions.emplace(Id, std::move(Fn));
+    }
+  }
+
+  /// \brief Return the number of functions
+  size_t size() const { return Functions.size(); }
+
+  /// \brief Return whether the module has no functions
+  bool empty() const { return Functions.empty(); }
+
+  /// \brief Return the function with UUID \p Id, or null
+  const FunctionType* find(const UUID& Id) const {
+    auto It = Functions.find(Id);
+    return It == Functions.end() ? nullptr : &It->second;
+  }
+
+  /// \brief Return a range of all the functions, in the same order as
+  /// \ref build_functions
+  auto functions() const { return Functions | ::boost::adaptors::map_values; }
+
+  /// \brief Return the UUIDs of the functions containing \p Block
+  std::vector<UUID> owners(const CodeBlock* Block) const {
+    auto It = Owners.find(Block);
+    return It == Owners.end() ? std::vector<UUID>() : It->second;
+  }
+
+  /// \brief Return copies of all the functions, in the same order as
+  /// \ref build_functions
+  std::vector<FunctionType> snapshot() const {
+    auto Range = functions();
+    return std::vector<FunctionType>(Range.begin(), Range.end());
+  }
+
+  /// \brief Rebuild function \p FnId from the module's AuxData
+  ///
+  /// Adds the function if it is new, and removes it if it is no longer in
+  /// FunctionEntries.
+  void function_changed(const UUID& FnId) {
+    auto It = Functions.find(FnId);
+    if (It != Functions.end()) {
+      removeOwners(It->second);
+      Functions.erase(It);
+    }
+
+    auto* EntriesByFn = Mod.template getAuxData<schema::FunctionEntries>();
+    if (!EntriesByFn) {
+      return;
+    }
+    auto EntryIt = EntriesByFn->find(FnId);
+    if (EntryIt == EntriesByFn->end()) {
+      return;
+    }
+
+    const detail::DirectLookup Lookup{Ctx, Mod};
+    FunctionType Fn = FunctionType::build_function(
+        Lookup, Mod, 0, FnId, EntryIt->second,
+        Mod.template getAuxData<schema::FunctionBlocks>(),
+        Mod.template getAuxData<schema::FunctionNames>(), Exits);
+    if (Exits == ExitBlockMode::Eager) {
+      Fn.getExitBlocks();
+    }
+    addOwners(Fn);
+    Functions.emplace(FnId, std::move(Fn));
+  }
+
+  /// \brief Rebuild each function in \p FnIds
+  template <class RangeType> void functions_changed(const RangeType& FnIds) {
+    for (const UUID& FnId : FnIds) {
+      function_changed(FnId);
+    }
+  }
+
+  /// \brief Recompute the exit blocks and local CFGs affected by adding or
+  /// removing a CFG edge out of \p Source
+  void edge_changed(const CfgNode& Source) {
+    auto It = Owners.find(&Source);
+    if (It == Owners.end()) {
+      return;
+    }
+    for (const UUID& FnId : It->second) {
+      FunctionType& Fn = Functions.at(FnId);
+      // Drops the cached exits and CFG, without touching earlier snapshots
+      Fn.mutableData();
+      if (Exits == ExitBlockMode::Eager) {
+        Fn.getExitBlocks();
+      }
+    }
+  }
+
+private:
+  void addOwners(const FunctionType& Fn) {
+    for (const CodeBlock* Block : Fn.Data->AllBlocks) {
+      Owners[Block].push_back(Fn.getUUID());
+    }
+  }
+
+  void removeOwners(const FunctionType& Fn) {
+    for (const CodeBlock* Block : Fn.Data->AllBlocks) {
+      auto It = Owners.find(Block);
+      auto& Ids = It->second;
+      Ids.erase(std::find(Ids.begin(), Ids.end(), Fn.getUUID()));
+      if (Ids.empty()) {
+        Owners.erase(It);
+      }
+    }
+  }
+
+  ContextType& Ctx;
+  ModuleType& Mod;
+  ExitBlockMode Exits;
+
+  std::map<UUID, FunctionType> Functions;
+  std::unordered_map<const CfgNode*, std::vector<UUID>> Owners;
+};
+
+} // namespace gtirb
+
+#endif // GTIRB_FN_SET_H
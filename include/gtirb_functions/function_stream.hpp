@@ -0,0 +1,764 @@
+//===- function_stream.hpp --------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_FN_STREAM_H
+#define GTIRB_FN_STREAM_H
+
+#include "gtirb_functions.hpp"
+#include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <optional>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gtirb {
+
+/// \brief A code block, as read by \ref read_functions
+struct StreamedBlock {
+  UUID Uuid;
+
+  /// \brief The address of the block, if its byte interval has one
+  std::optional<uint64_t> Address;
+
+  uint64_t Size = 0;
+};
+
+/// \brief An exit block of a \ref StreamedFunction
+struct StreamedExit {
+  /// \brief The index of the block in StreamedModule::Blocks
+  uint32_t Block;
+
+  /// \brief Bitwise OR of the ExitKind values that apply to the block
+  uint8_t Kinds;
+
+  /// \brief Return whether control leaves the function in way \p K
+  bool is(ExitKind K) const { return (Kinds & static_cast<uint8_t>(K)) != 0; }
+};
+
+/// \brief A function, as read by \ref read_functions
+///
+/// Blocks are indices into StreamedModule::Blocks, in increasing order. The
+/// names follow the same rules as the matching Function accessors.
+struct StreamedFunction {
+  UUID Uuid;
+  std::vector<uint32_t> EntryBlocks;
+  std::vector<uint32_t> AllBlocks;
+  std::vector<StreamedExit> ExitBlocks;
+
+  /// \brief The names of the symbols referring to the entry blocks
+  std::vector<std::string> Names;
+
+  /// \brief The name recorded in FunctionNames, if any
+  std::optional<std::string> Name;
+
+  /// \brief The same name as Function::getLongName()
+  std::string LongName;
+};
+
+/// \brief The functions of one module, as read by \ref read_functions
+struct StreamedModule {
+  std::string Name;
+
+  /// \brief The code blocks of the module, in address order, with blocks
+  /// without an address last
+  std::vector<StreamedBlock> Blocks;
+
+  /// \brief The functions of the module, in FunctionEntries order
+  std::vector<StreamedFunction> Functions;
+};
+
+namespace detail {
+
+/// \brief Field numbers of the GTIRB protobuf messages read by \ref
+/// read_functions. Every other field is skipped without being decoded.
+namespace proto {
+// IR
+constexpr uint32_t IrModules = 2;
+constexpr uint32_t IrCfg = 6;
+// Module
+constexpr uint32_t ModuleName = 7;
+constexpr uint32_t ModuleSymbols = 9;
+constexpr uint32_t ModuleSections = 12;
+constexpr uint32_t ModuleAuxData = 13;
+// map<string, AuxData> entries
+constexpr uint32_t MapKey = 1;
+constexpr uint32_t MapValue = 2;
+// AuxData
+constexpr uint32_t AuxDataData = 2;
+// Section
+constexpr uint32_t SectionByteIntervals = 5;
+// ByteInterval
+constexpr uint32_t IntervalBlocks = 2;
+constexpr uint32_t IntervalHasAddress = 4;
+constexpr uint32_t IntervalAddress = 5;
+// Block
+constexpr uint32_t BlockOffset = 1;
+constexpr uint32_t BlockCode = 2;
+// CodeBlock
+constexpr uint32_t CodeBlockUuid = 1;
+constexpr uint32_t CodeBlockSize = 2;
+// Symbol
+constexpr uint32_t SymbolUuid = 1;
+constexpr uint32_t SymbolName = 2;
+constexpr uint32_t SymbolReferent = 6;
+// CFG
+constexpr uint32_t CfgEdges = 2; // 1 is reserved, and 3 holds the vertices
+// Edge
+constexpr uint32_t EdgeSource = 1;
+constexpr uint32_t EdgeTarget = 2;
+constexpr uint32_t EdgeLabelField = 5;
+// EdgeLabel
+constexpr uint32_t LabelDirect = 2;
+constexpr uint32_t LabelType = 3;
+
+enum WireType : uint32_t { Varint = 0, Fixed64 = 1, Bytes = 2, Fixed32 = 5 };
+
+/// \brief Thrown on malformed input; never escapes \ref read_functions
+struct ParseError {};
+
+/// \brief Reads protobuf wire format from a stream buffer, one field at a
+/// time
+///
+/// Fields that are not needed are skipped by seeking when the buffer
+/// supports it, so large payloads such as byte interval contents are never
+/// read into memory.
+class WireReader {
+public:
+  explicit WireReader(std::streambuf& B) : Buf(B) {}
+
+  /// \brief Return whether the current message has more fields
+  bool more() {
+    if (Limit != NoLimit) {
+      return Pos < Limit;
+    }
+    return Buf.sgetc() != std::streambuf::traits_type::eof();
+  }
+
+  /// \brief Return the next byte, without consuming it
+  int peek() { return Buf.sgetc(); }
+
+  uint8_t byte() {
+    auto C = Buf.sbumpc();
+    if (C == std::streambuf::traits_type::eof() || Pos >= Limit) {
+      throw ParseError();
+    }
+    ++Pos;
+    return static_cast<uint8_t>(C);
+  }
+
+  uint64_t varint() {
+    uint64_t Value = 0;
+    for (unsigned Shift = 0; Shift < 64; Shift += 7) {
+      uint8_t B = byte();
+      Value |= uint64_t(B & 0x7f) << Shift;
+      if (!(B & 0x80)) {
+        return Value;
+      }
+    }
+    throw ParseError();
+  }
+
+  /// \brief Read a field tag, as a field number and a wire type
+  std::pair<uint32_t, uint32_t> tag() {
+    uint64_t Tag = varint();
+    return {static_cast<uint32_t>(Tag >> 3), static_cast<uint32_t>(Tag & 7)};
+  }
+
+  /// \brief Read the length of a length-delimited field
+  uint64_t length() {
+    uint64_t Length = varint();
+    if (Limit != NoLimit && Length > Limit - Pos) {
+      throw ParseError();
+    }
+    return Length;
+  }
+
+  void read(void* Out, uint64_t Size) {
+    if (Limit != NoLimit && Size > Limit - Pos) {
+      throw ParseError();
+    }
+    auto Got = Buf.sgetn(static_cast<char*>(Out),
+                         static_cast<std::streamsize>(Size));
+    if (static_cast<uint64_t>(Got) != Size) {
+      throw ParseError();
+    }
+    Pos += Size;
+  }
+
+  std::string string() {
+    std::string Str(length(), '\0');
+    read(Str.data(), Str.size());
+    return Str;
+  }
+
+  UUID uuid() {
+    UUID Id;
+    if (length() != sizeof(Id.data)) {
+      throw ParseError();
+    }
+    read(Id.data, sizeof(Id.data));
+    return Id;
+  }
+
+  void skip(uint64_t Size) {
+    if (Limit != NoLimit && Size > Limit - Pos) {
+      throw ParseError();
+    }
+    auto Off = static_cast<std::streamoff>(Size);
+    if (Buf.pubseekoff(Off, std::ios_base::cur, std::ios_base::in) ==
+        std::streampos(std::streamoff(-1))) {
+      char Scratch[4096];
+      for (uint64_t Left = Size; Left > 0;) {
+        auto Chunk = std::min<uint64_t>(Left, sizeof(Scratch));
+        if (Buf.sgetn(Scratch, static_cast<std::streamsize>(Chunk)) !=
+            static_cast<std::streamsize>(Chunk)) {
+          throw ParseError();
+        }
+        Left -= Chunk;
+      }
+    }
+    Pos += Size;
+  }
+
+  /// \brief Skip the value of a field of wire type \p Type
+  void skipField(uint32_t Type) {
+    switch (Type) {
+    case Varint:
+      varint();
+      break;
+    case Fixed64:
+      skip(8);
+      break;
+    case Bytes:
+      skip(length());
+      break;
+    case Fixed32:
+      skip(4);
+      break;
+    default:
+      throw ParseError();
+    }
+  }
+
+  /// \brief Read an embedded message, calling \p Field(Number, WireType) for
+  /// each of its fields. \p Field must consume or skip the field's value.
+  template <class FieldFn> void message(FieldFn Field) {
+    uint64_t Length = length();
+    uint64_t Outer = Limit;
+    Limit = Pos + Length;
+    while (Pos < Limit) {
+      auto [Number, Type] = tag();
+      Field(Number, Type);
+    }
+    if (Pos != Limit) {
+      throw ParseError();
+    }
+    Limit = Outer;
+  }
+
+private:
+  static constexpr uint64_t NoLimit = UINT64_MAX;
+
+  std::streambuf& Buf;
+  uint64_t Pos = 0;
+  uint64_t Limit = NoLimit;
+};
+
+/// \brief Decodes the payload of a serialized AuxData table
+class AuxDataReader {
+public:
+  explicit AuxDataReader(std::string_view Bytes) : Data(Bytes) {}
+
+  uint64_t u64() {
+    uint64_t Value = 0;
+    need(8);
+    for (unsigned I = 0; I < 8; ++I) {
+      Value |= uint64_t(static_cast<uint8_t>(Data[Pos + I])) << (8 * I);
+    }
+    Pos += 8;
+    return Value;
+  }
+
+  UUID uuid() {
+    UUID Id;
+    need(sizeof(Id.data));
+    std::memcpy(Id.data, Data.data() + Pos, sizeof(Id.data));
+    Pos += sizeof(Id.data);
+    return Id;
+  }
+
+  /// \brief Read a map<UUID, set<UUID>>
+  std::vector<std::pair<UUID, std::vector<UUID>>> uuidSetMap() {
+    std::vector<std::pair<UUID, std::vector<UUID>>> Map(count(16 + 8));
+    for (auto& [Key, Values] : Map) {
+      Key = uuid();
+      Values.resize(count(16));
+      for (UUID& Value : Values) {
+        Value = uuid();
+      }
+    }
+    return Map;
+  }
+
+  /// \brief Read a map<UUID, UUID>
+  std::vector<std::pair<UUID, UUID>> uuidMap() {
+    std::vector<std::pair<UUID, UUID>> Map(count(32));
+    for (auto& [Key, Value] : Map) {
+      Key = uuid();
+      Value = uuid();
+    }
+    return Map;
+  }
+
+private:
+  void need(size_t Size) const {
+    if (Size > Data.size() - Pos) {
+      throw ParseError();
+    }
+  }
+
+  /// \brief Read an element count, checking it against the bytes left
+  size_t count(size_t MinElementSize) {
+    uint64_t Count = u64();
+    if (Count > (Data.size() - Pos) / MinElementSize) {
+      throw ParseError();
+    }
+    return static_cast<size_t>(Count);
+  }
+
+  std::string_view Data;
+  size_t Pos = 0;
+};
+
+/// \brief What \ref read_functions keeps of a module while reading
+struct RawModule {
+  struct RawSymbol {
+    UUID Uuid;
+    std::string Name;
+    std::optional<UUID> Referent;
+  };
+
+  std::string Name;
+  std::vector<StreamedBlock> Blocks;
+  std::vector<RawSymbol> Symbols;
+  std::optional<std::string> Entries;
+  std::optional<std::string> FnBlocks;
+  std::optional<std::string> FnNames;
+};
+
+/// \brief What \ref read_functions keeps of a CFG edge
+struct RawEdge {
+  UUID Source;
+  UUID Target;
+  EdgeType Type;
+  DirectEdge Direct;
+};
+
+inline void readCodeBlock(WireReader& In, std::vector<StreamedBlock>& Blocks,
+                          std::vector<uint64_t>& Offsets) {
+  uint64_t Offset = 0;
+  std::optional<StreamedBlock> Block;
+  In.message([&](uint32_t Number, uint32_t Type) {
+    if (Number == BlockOffset && Type == Varint) {
+      Offset = In.varint();
+    } else if (Number == BlockCode && Type == Bytes) {
+      Block.emplace();
+      In.message([&](uint32_t N, uint32_t T) {
+        if (N == CodeBlockUuid && T == Bytes) {
+          Block->Uuid = In.uuid();
+        } else if (N == CodeBlockSize && T == Varint) {
+          Block->Size = In.varint();
+        } else {
+          In.skipField(T);
+        }
+      });
+    } else {
+      In.skipField(Type);
+    }
+  });
+  if (Block) {
+    Blocks.push_back(*Block);
+    Offsets.push_back(Offset);
+  }
+}
+
+inline void readByteInterval(WireReader& In,
+                             std::vector<StreamedBlock>& Blocks) {
+  size_t First = Blocks.size();
+  std::vector<uint64_t> Offsets;
+  bool HasAddress = false;
+  uint64_t Address = 0;
+  In.message([&](uint32_t Number, uint32_t Type) {
+    if (Number == IntervalBlocks && Type == Bytes) {
+      readCodeBlock(In, Blocks, Offsets);
+    } else if (Number == IntervalHasAddress && Type == Varint) {
+      HasAddress = In.varint() != 0;
+    } else if (Number == IntervalAddress && Type == Varint) {
+      Address = In.varint();
+    } else {
+      // Including the contents, which are never read
+      In.skipField(Type);
+    }
+  });
+  if (HasAddress) {
+    for (size_t I = First; I < Blocks.size(); ++I) {
+      Blocks[I].Address = Address + Offsets[I - First];
+    }
+  }
+}
+
+inline void readModule(WireReader& In, RawModule& Mod) {
+  In.message([&](uint32_t Number, uint32_t Type) {
+    if (Number == ModuleName && Type == Bytes) {
+      Mod.Name = In.string();
+    } else if (Number == ModuleSymbols && Type == Bytes) {
+      RawModule::RawSymbol Sym;
+      In.message([&](uint32_t N, uint32_t T) {
+        if (N == SymbolUuid && T == Bytes) {
+          Sym.Uuid = In.uuid();
+        } else if (N == SymbolName && T == Bytes) {
+          Sym.Name = In.string();
+        } else if (N == SymbolReferent && T == Bytes) {
+          Sym.Referent = In.uuid();
+        } else {
+          In.skipField(T);
+        }
+      });
+      Mod.Symbols.push_back(std::move(Sym));
+    } else if (Number == ModuleSections && Type == Bytes) {
+      In.message([&](uint32_t N, uint32_t T) {
+        if (N == SectionByteIntervals && T == Bytes) {
+          readByteInterval(In, Mod.Blocks);
+        } else {
+          In.skipField(T);
+        }
+      });
+    } else if (Number == ModuleAuxData && Type == Bytes) {
+      std::string Key;
+      std::optional<std::string> Value;
+      In.message([&](uint32_t N, uint32_t T) {
+        if (N == MapKey && T == Bytes) {
+          Key = In.string();
+        } else if (N == MapValue && T == Bytes &&
+                   (Key.empty() || Key == "functionEntries" ||
+                    Key == "functionBlocks" || Key == "functionNames")) {
+          // An empty key means the value came first; keep it just in case
+          In.message([&](uint32_t VN, uint32_t VT) {
+            if (VN == AuxDataData && VT == Bytes) {
+              Value = In.string();
+            } else {
+              In.skipField(VT);
+            }
+          });
+        } else {
+          In.skipField(T);
+        }
+      });
+      if (Key == "functionEntries") {
+        Mod.Entries = std::move(Value);
+      } else if (Key == "functionBlocks") {
+        Mod.FnBlocks = std::move(Value);
+      } else if (Key == "functionNames") {
+        Mod.FnNames = std::move(Value);
+      }
+    } else {
+      In.skipField(Type);
+    }
+  });
+}
+
+inline void readCfg(WireReader& In, std::vector<RawEdge>& Edges) {
+  In.message([&](uint32_t Number, uint32_t Type) {
+    if (Number != CfgEdges || Type != Bytes) {
+      In.skipField(Type);
+      return;
+    }
+    RawEdge Edge{};
+    bool Labeled = false;
+    uint64_t EdgeKind = 0;
+    bool Direct = false;
+    In.message([&](uint32_t N, uint32_t T) {
+      if (N == EdgeSource && T == Bytes) {
+        Edge.Source = In.uuid();
+      } else if (N == EdgeTarget && T == Bytes) {
+        Edge.Target = In.uuid();
+      } else if (N == EdgeLabelField && T == Bytes) {
+        Labeled = true;
+        In.message([&](uint32_t LN, uint32_t LT) {
+          if (LN == LabelType && LT == Varint) {
+            EdgeKind = In.varint();
+          } else if (LN == LabelDirect && LT == Varint) {
+            Direct = In.varint() != 0;
+          } else {
+            In.skipField(LT);
+          }
+        });
+      } else {
+        In.skipField(T);
+      }
+    });
+    // Unlabeled edges never make exits
+    if (Labeled && EdgeKind <= static_cast<uint64_t>(EdgeType::Sysret)) {
+      Edge.Type = static_cast<EdgeType>(EdgeKind);
+      Edge.Direct = Direct ? DirectEdge::IsDirect : DirectEdge::IsIndirect;
+      Edges.push_back(Edge);
+    }
+  });
+}
+
+} // namespace proto
+
+} // namespace detail
+
+/// \brief Read the functions of every module of a serialized IR, without
+/// loading the IR
+///
+/// Only the function AuxData tables, the symbols, the code blocks' UUIDs,
+/// offsets and sizes, and the CFG edges are decoded. Byte interval contents,
+/// symbolic expressions, data blocks and every other AuxData table are
+/// skipped over, seeking past them if \p In supports it, so memory use is a
+/// small fraction of loading the IR. The result matches \ref build_functions
+/// on the loaded IR.
+///
+/// \param In a .gtirb file, opened in binary mode
+/// \param ComputeExits whether to compute exit blocks; this is the only part
+/// that needs the CFG
+///
+/// \return the functions of each module, in IR order, or nothing if \p In is
+/// not a well-formed serialized IR
+inline std::optional<std::vector<StreamedModule>>
+read_functions(std::istream& In, bool ComputeExits = true) {
+  namespace proto = detail::proto;
+  std::vector<detail::proto::RawModule> Raw;
+  std::vector<detail::proto::RawEdge> Edges;
+  std::vector<StreamedModule> Mods;
+  try {
+    std::streambuf* Buf = In.rdbuf();
+    if (!Buf) {
+      return std::nullopt;
+    }
+    proto::WireReader Reader(*Buf);
+    // Files start with an 8 byte "GTIRB" header; a serialized IR never
+    // starts with a 'G'.
+    if (Reader.peek() == 'G') {
+      char Magic[8];
+      Reader.read(Magic, sizeof(Magic));
+      if (std::memcmp(Magic, "GTIRB", 5) != 0) {
+        return std::nullopt;
+      }
+    }
+    while (Reader.more()) {
+      auto [Number, Type] = Reader.tag();
+      if (Number == proto::IrModules && Type == proto::Bytes) {
+        proto::readModule(Reader, Raw.emplace_back());
+      } else if (Number == proto::IrCfg && Type == proto::Bytes &&
+                 ComputeExits) {
+        proto::readCfg(Reader, Edges);
+      } else {
+        Reader.skipField(Type);
+      }
+    }
+
+    // Locate every code block by UUID, as (module, block)
+    std::unordered_map<UUID, std::pair<uint32_t, uint32_t>, boost::hash<UUID>>
+        BlockIndex;
+    for (size_t M = 0; M < Raw.size(); ++M) {
+      auto& Blocks = Raw[M].Blocks;
+      std::sort(Blocks.begin(), Blocks.end(), [](const auto& A, const auto& B) {
+        if (A.Address.has_value() != B.Address.has_value()) {
+          return A.Address.has_value();
+        }
+        if (A.Address && *A.Address != *B.Address) {
+          return *A.Address < *B.Address;
+        }
+        return A.Uuid < B.Uuid;
+      });
+      for (size_t I = 0; I < Blocks.size(); ++I) {
+        BlockIndex.emplace(Blocks[I].Uuid,
+                           std::make_pair(static_cast<uint32_t>(M),
+                                          static_cast<uint32_t>(I)));
+      }
+    }
+
+    for (size_t M = 0; M < Raw.size(); ++M) {
+      auto& RawMod = Raw[M];
+      StreamedModule& Mod = Mods.emplace_back();
+      Mod.Name = std::move(RawMod.Name);
+      if (!RawMod.Entries) {
+        Mod.Blocks = std::move(RawMod.Blocks);
+        continue;
+      }
+
+      auto blockOf = [&](const UUID& Id) -> std::optional<uint32_t> {
+        auto It = BlockIndex.find(Id);
+        if (It == BlockIndex.end() || It->second.first != M) {
+          return std::nullopt;
+        }
+        return It->second.second;
+      };
+      std::unordered_map<UUID, uint32_t, boost::hash<UUID>> SymbolById;
+      std::unordered_map<uint32_t, std::vector<uint32_t>> SymbolsByBlock;
+      for (size_t I = 0; I < RawMod.Symbols.size(); ++I) {
+        const auto& Sym = RawMod.Symbols[I];
+        SymbolById.emplace(Sym.Uuid, static_cast<uint32_t>(I));
+        if (Sym.Referent) {
+          if (auto B = blockOf(*Sym.Referent)) {
+            SymbolsByBlock[*B].push_back(static_cast<uint32_t>(I));
+          }
+        }
+      }
+
+      auto Entries = proto::AuxDataReader(*RawMod.Entries).uuidSetMap();
+      std::unordered_map<UUID, std::vector<UUID>, boost::hash<UUID>> FnBlocks;
+      if (RawMod.FnBlocks) {
+        for (auto& [FnId, Ids] :
+             proto::AuxDataReader(*RawMod.FnBlocks).uuidSetMap()) {
+          FnBlocks.emplace(FnId, std::move(Ids));
+        }
+      }
+      std::unordered_map<UUID, UUID, boost::hash<UUID>> FnNames;
+      if (RawMod.FnNames) {
+        for (auto& [FnId, NameId] :
+             proto::AuxDataReader(*RawMod.FnNames).uuidMap()) {
+          FnNames.emplace(FnId, NameId);
+        }
+      }
+
+      auto resolveAll = [&](const std::vector<UUID>& Ids) {
+        std::vector<uint32_t> Indices;
+        Indices.reserve(Ids.size());
+        for (const UUID& Id : Ids) {
+          if (auto B = blockOf(Id)) {
+            Indices.push_back(*B);
+          }
+        }
+        std::sort(Indices.begin(), Indices.end());
+        return Indices;
+      };
+
+      Mod.Functions.reserve(Entries.size());
+      for (auto& [FnId, EntryIds] : Entries) {
+        StreamedFunction& Fn = Mod.Functions.emplace_back();
+        Fn.Uuid = FnId;
+        Fn.EntryBlocks = resolveAll(EntryIds);
+        if (auto It = FnBlocks.find(FnId); It != FnBlocks.end()) {
+          Fn.AllBlocks = resolveAll(It->second);
+        }
+
+        std::optional<uint32_t> Canon;
+        if (auto It = FnNames.find(FnId); It != FnNames.end()) {
+          if (auto S = SymbolById.find(It->second); S != SymbolById.end()) {
+            Canon = S->second;
+            Fn.Name = RawMod.Symbols[S->second].Name;
+          }
+        }
+        std::vector<std::string_view> Aliases;
+        for (uint32_t B : Fn.EntryBlocks) {
+          auto It = SymbolsByBlock.find(B);
+          if (It == SymbolsByBlock.end()) {
+            continue;
+          }
+          for (uint32_t S : It->second) {
+            Fn.Names.push_back(RawMod.Symbols[S].Name);
+            if (S != Canon) {
+              Aliases.push_back(RawMod.Symbols[S].Name);
+            }
+          }
+        }
+        if (Fn.Names.empty()) {
+          Fn.LongName = "<unknown>";
+        } else if (Fn.Names.size() == 1) {
+          Fn.LongName = Fn.Names.front();
+        } else {
+          std::string_view CanonName =
+              Fn.Name ? std::string_view(*Fn.Name) : "<unknown>";
+          Fn.LongName = detail::formatLongName(CanonName, std::move(Aliases));
+        }
+      }
+      Mod.Blocks = std::move(RawMod.Blocks);
+      std::vector<detail::proto::RawModule::RawSymbol>().swap(RawMod.Symbols);
+    }
+
+    if (ComputeExits) {
+      // Map every block to the functions containing it, per module
+      std::vector<std::vector<std::vector<uint32_t>>> Owners(Mods.size());
+      for (size_t M = 0; M < Mods.size(); ++M) {
+        Owners[M].resize(Mods[M].Blocks.size());
+        for (size_t F = 0; F < Mods[M].Functions.size(); ++F) {
+          for (uint32_t B : Mods[M].Functions[F].AllBlocks) {
+            Owners[M][B].push_back(static_cast<uint32_t>(F));
+          }
+        }
+      }
+      for (const auto& Edge : Edges) {
+        auto Source = BlockIndex.find(Edge.Source);
+        if (Source == BlockIndex.end()) {
+          continue;
+        }
+        auto [M, B] = Source->second;
+        const auto& SourceOwners = Owners[M][B];
+        if (SourceOwners.empty()) {
+          continue;
+        }
+        auto Target = BlockIndex.find(Edge.Target);
+        bool TargetIsCodeBlock = Target != BlockIndex.end();
+        const std::vector<uint32_t>* TargetOwners = nullptr;
+        if (TargetIsCodeBlock && Target->second.first == M) {
+          TargetOwners = &Owners[M][Target->second.second];
+        }
+        for (uint32_t F : SourceOwners) {
+          bool InFunction =
+              TargetOwners && std::binary_search(TargetOwners->begin(),
+                                                 TargetOwners->end(), F);
+          if (uint8_t Kind = detail::classifyExitEdge(
+                  Edge.Type, Edge.Direct, TargetIsCodeBlock, InFunction)) {
+            Mods[M].Functions[F].ExitBlocks.push_back({B, Kind});
+          }
+        }
+      }
+      for (auto& Mod : Mods) {
+        for (auto& Fn : Mod.Functions) {
+          auto& Exits = Fn.ExitBlocks;
+          std::sort(Exits.begin(), Exits.end(),
+                    [](const auto& A, const auto& C) {
+                      return A.Block < C.Block;
+                    });
+          size_t Out = 0;
+          for (size_t I = 0; I < Exits.size(); ++I) {
+            if (Out > 0 && Exits[Out - 1].Block == Exits[I].Block) {
+              Exits[Out - 1].Kinds |= Exits[I].Kinds;
+            } else {
+              Exits[Out++] = Exits[I];
+            }
+          }
+          Exits.resize(Out);
+        }
+      }
+    }
+  } catch (const detail::proto::ParseError&) {
+    return std::nullopt;
+  }
+  return Mods;
+}
+
+} // namespace gtirb
+
+#endif // GTIRB_FN_STREAM_H
@@ -0,0 +1,375 @@
+//===- function_table.hpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_FN_TABLE_H
+#define GTIRB_FN_TABLE_H
+
+#include "gtirb_functions.hpp"
+#include <boost/range.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace gtirb {
+
+/// \class FunctionTable<T> is a compact, read-only table of the functions of
+/// a module.
+///
+/// All code block pointers of all functions are stored in one contiguous
+/// arena and all symbol pointers in another. Each \ref Entry only holds
+/// ranges into those arenas, so iterating a function walks adjacent memory
+/// and a table costs a pointer per element instead of a hash node.
+///
+/// Within a function each block range is sorted by pointer value, which gives
+/// membership tests by binary search. As with \class Function, the order of
+/// blocks within a range is otherwise arbitrary.
+///
+/// A table is best built straight from the function AuxData of a module,
+/// which never creates the per-function hash sets of \class Function. It may
+/// also be copied from the result of \ref build_functions.
+template <class ModuleType> class FunctionTable {
+public:
+  using FunctionType = Function<ModuleType>;
+  using CodeBlockType = typename FunctionType::CodeBlockType;
+  using SymbolType = typename FunctionType::SymbolType;
+
+  /// \brief Iterators over code blocks, in an arbitrary order
+  using code_block_iterator = CodeBlockType* const*;
+
+  /// \brief Ranges of code blocks
+  using code_block_range = ::boost::iterator_range<code_block_iterator>;
+
+  /// \brief Iterators over symbols, in an arbitrary order
+  using symbol_iterator = SymbolType* const*;
+
+  /// \brief Ranges over symbols
+  using symbol_range = ::boost::iterator_range<symbol_iterator>;
+
+  /// \class Entry is the view of one function in a FunctionTable, with the
+  /// same range API as \class Function.
+  class Entry {
+  public:
+    /// \brief Return an iterator to the first entry block
+    code_block_iterator entry_blocks_begin() const {
+      return EntryBlocks.begin();
+    }
+
+    /// \brief Return an iterator to the element after the last entry block
+    code_block_iterator entry_blocks_end() const { return EntryBlocks.end(); }
+
+    /// \brief Return the entry blocks of the function, as a range
+    code_block_range entry_blocks() const { return EntryBlocks; }
+
+    /// \brief Return an iterator to the first exit block
+    code_block_iterator exit_blocks_begin() const {
+      return ExitBlocks.begin();
+    }
+
+    /// \brief Return an iterator to the element after the last exit block
+    code_block_iterator exit_blocks_end() const { return ExitBlocks.end(); }
+
+    /// \brief Return a range of the exit blocks
+    code_block_range exit_blocks() const { return ExitBlocks; }
+
+    /// \brief Return an iterator to the first code block in the function
+    code_block_iterator all_blocks_begin() const { return AllBlocks.begin(); }
+
+    /// \brief Return an iterator to the element after the last code block
+    code_block_iterator all_blocks_end() const { return AllBlocks.end(); }
+
+    /// \brief Return a range of all the code blocks in the function
+    code_block_range all_blocks() const { return AllBlocks; }
+
+    /// \brief Return an iterator to the first symbol for the function name
+    symbol_iterator name_symbols_begin() const { return NameSymbols.begin(); }
+
+    /// \brief Return an iterator to the element after the last symbol for the
+    /// function name
+    symbol_iterator name_symbols_end() const { return NameSymbols.end(); }
+
+    /// \brief Return a range of the symbols for the function name
+    symbol_range name_symbols() const { return NameSymbols; }
+
+    /// \brief Returns the name of the function as recorded in AuxData
+    SymbolType* getName() const { return CanonName; }
+
+    /// \brief Returns the UUID of the function
+    const UUID& getUUID() const { return Uuid; }
+
+    /// \brief Return whether \p Block is one of the function's blocks
+    bool contains(const CodeBlock* Block) const {
+      return find(AllBlocks, Block);
+    }
+
+    /// \brief Return whether \p Block is one of the function's entry blocks
+    bool is_entry(const CodeBlock* Block) const {
+      return find(EntryBlocks, Block);
+    }
+
+    /// \brief Return whether \p Block is one of the function's exit blocks
+    bool is_exit(const CodeBlock* Block) const {
+      return find(ExitBlocks, Block);
+    }
+
+  private:
+    friend class FunctionTable;
+
+    static bool find(code_block_range Blocks, const CodeBlock* Block) {
+      return std::binary_search(Blocks.begin(), Blocks.end(), Block,
+                                std::less<const CodeBlock*>());
+    }
+
+    UUID Uuid;
+    SymbolType* CanonName;
+    code_block_range EntryBlocks;
+    code_block_range ExitBlocks;
+    code_block_range AllBlocks;
+    symbol_range NameSymbols;
+  };
+
+  using iterator = typename std::vector<Entry>::const_iterator;
+
+  /// \brief Build the table of the functions of \p Mod from its function
+  /// AuxData, in the order \ref build_functions returns them
+  ///
+  /// References are resolved through \p Opts.Resolver if it was built for
+  /// \p Mod, and through a new \ref UUIDResolver otherwise, and names through
+  /// a \ref SymbolIndex. Exit blocks are classified in one pass over the
+  /// CFG, unless \p Opts.ExitBlocks is ExitBlockMode::Skip. The other options
+  /// are ignored.
+  FunctionTable(const Context& C, ModuleType& Mod,
+                const FunctionBuildOptions& Opts = FunctionBuildOptions()) {
+    if (!Mod.template getAuxData<schema::FunctionEntries>()) {
+      return;
+    }
+    std::optional<UUIDResolver> LocalResolver;
+    const UUIDResolver* Resolver = Opts.Resolver;
+    if (!Resolver || !Resolver->covers(Mod)) {
+      Resolver = &LocalResolver.emplace(C, Mod);
+    }
+    const SymbolIndex<const Module> Names(Mod);
+
+    std::vector<Spans> FnSpans;
+    FnSpans.reserve(Resolver->size());
+    Entries.reserve(Resolver->size());
+    for (size_t Fn = 0; Fn < Resolver->size(); ++Fn) {
+      Entry E;
+      E.Uuid = Resolver->function(Fn);
+      E.CanonName = const_cast<SymbolType*>(Resolver->name(Fn));
+      Spans S;
+
+      size_t First = Blocks.size();
+      for (const CodeBlock* Block : Resolver->entry_blocks(Fn)) {
+        Blocks.push_back(const_cast<CodeBlockType*>(Block));
+      }
+      S.EntryBlocks = sortSection(Blocks, First);
+
+      First = Blocks.size();
+      for (const CodeBlock* Block : Resolver->blocks(Fn)) {
+        Blocks.push_back(const_cast<CodeBlockType*>(Block));
+      }
+      S.AllBlocks = sortSection(Blocks, First);
+
+      First = Symbols.size();
+      for (size_t I = S.EntryBlocks.first; I < S.EntryBlocks.second; ++I) {
+        for (const Symbol* Sym : Names.symbols(Blocks[I])) {
+          Symbols.push_back(const_cast<SymbolType*>(Sym));
+        }
+      }
+      S.NameSymbols = sortSection(Symbols, First);
+
+      S.ExitBlocks = {Blocks.size(), Blocks.size()};
+      FnSpans.push_back(S);
+      Entries.push_back(E);
+    }
+
+    if (Opts.ExitBlocks != ExitBlockMode::Skip) {
+      classifyExits(Mod.getIR(), FnSpans);
+    }
+    setRanges(FnSpans);
+  }
+
+  /// \brief Copy the functions in \p Fns into a new table
+  ///
+  /// Exit blocks not yet known are classified first, in one pass over the
+  /// CFG. They are empty for functions built with ExitBlockMode::Skip.
+  explicit FunctionTable(const std::vector<FunctionType>& Fns) {
+    // Copies share their data, so classifying them fills in the results.
+    std::vector<FunctionType> Classified = Fns;
+    classify_exits(Classified);
+
+    std::vector<Spans> FnSpans;
+    FnSpans.reserve(Fns.size());
+    Entries.reserve(Fns.size());
+    for (const auto& Fn : Fns) {
+      Entry E;
+      E.Uuid = Fn.getUUID();
+      E.CanonName = Fn.getName();
+      Spans S;
+      S.EntryBlocks = appendSorted(Blocks, Fn.entry_blocks());
+      S.ExitBlocks = appendSorted(Blocks, Fn.exit_blocks());
+      S.AllBlocks = appendSorted(Blocks, Fn.all_blocks());
+      S.NameSymbols = appendSorted(Symbols, Fn.name_symbols());
+      FnSpans.push_back(S);
+      Entries.push_back(E);
+    }
+    setRanges(FnSpans);
+  }
+
+  // Entries point into the arenas, which survive a move but not a copy.
+  FunctionTable(const FunctionTable&) = delete;
+  FunctionTable& operator=(const FunctionTable&) = delete;
+  FunctionTable(FunctionTable&&) = default;
+  FunctionTable& operator=(FunctionTable&&) = default;
+
+  /// \brief Return the number of functions in the table
+  size_t size() const { return Entries.size(); }
+
+  /// \brief Return whether the table holds no functions
+  bool empty() const { return Entries.empty(); }
+
+  /// \brief Return the function at position \p I, in build_functions order
+  const Entry& operator[](size_t I) const { return Entries[I]; }
+
+  /// \brief Return an iterator to the first function
+  iterator begin() const { return Entries.begin(); }
+
+  /// \brief Return an iterator to the element after the last function
+  iterator end() const { return Entries.end(); }
+
+  /// \brief Return an estimate of the memory held by the table, in bytes
+  uint64_t memory_usage() const {
+    return detail::vectorBytes(Blocks) + detail::vectorBytes(Symbols) +
+           detail::vectorBytes(Entries);
+  }
+
+private:
+  /// \brief A range of an arena, by offset, while the arena may still grow
+  using Span = std::pair<size_t, size_t>;
+
+  /// \brief The ranges of one entry, by offset
+  struct Spans {
+    Span EntryBlocks;
+    Span ExitBlocks;
+    Span AllBlocks;
+    Span NameSymbols;
+  };
+
+  /// \brief Sort and deduplicate the elements of \p Arena from \p First on
+  template <class T>
+  static Span sortSection(std::vector<T*>& Arena, size_t First) {
+    std::sort(Arena.begin() + First, Arena.end(), std::less<const T*>());
+    Arena.erase(std::unique(Arena.begin() + First, Arena.end()), Arena.end());
+    return {First, Arena.size()};
+  }
+
+  /// \brief Append \p Range to \p Arena, sorted, and return its span
+  template <class T, class RangeType>
+  static Span appendSorted(std::vector<T*>& Arena, RangeType Range) {
+    size_t First = Arena.size();
+    Arena.insert(Arena.end(), Range.begin(), Range.end());
+    return sortSection(Arena, First);
+  }
+
+  /// \brief Append the exit blocks of every entry to the block arena, in one
+  /// pass over the edges of \p Ir
+  void classifyExits(const IR* Ir, std::vector<Spans>& FnSpans) {
+    if (!Ir) {
+      return;
+    }
+    // The functions of every block, found by binary search.
+    std::vector<std::pair<const CodeBlock*, uint32_t>> Owners;
+    for (size_t I = 0; I < FnSpans.size(); ++I) {
+      const Span& All = FnSpans[I].AllBlocks;
+      for (size_t J = All.first; J < All.second; ++J) {
+        Owners.emplace_back(Blocks[J], static_cast<uint32_t>(I));
+      }
+    }
+    std::sort(Owners.begin(), Owners.end());
+    auto byBlock = [](const auto& A, const auto& B) {
+      return std::less<const CodeBlock*>()(A.first, B.first);
+    };
+
+    std::vector<std::pair<uint32_t, CodeBlockType*>> Exits;
+    const CFG& Cfg = Ir->getCFG();
+    for (auto Edge : ::boost::make_iterator_range(::boost::edges(Cfg))) {
+      const EdgeLabel& Label = Cfg[Edge];
+      if (!Label) {
+        continue;
+      }
+      auto* Source = dyn_cast<CodeBlock>(Cfg[::boost::source(Edge, Cfg)]);
+      if (!Source) {
+        continue;
+      }
+      auto [First, Last] =
+          std::equal_range(Owners.begin(), Owners.end(),
+                           std::make_pair(Source, uint32_t(0)), byBlock);
+      if (First == Last) {
+        continue;
+      }
+      const CfgNode* Target = Cfg[::boost::target(Edge, Cfg)];
+      auto* TargetBlock = dyn_cast<CodeBlock>(Target);
+      for (auto It = First; It != Last; ++It) {
+        const Span& All = FnSpans[It->second].AllBlocks;
+        bool InFunction =
+            TargetBlock && std::binary_search(Blocks.begin() + All.first,
+                                              Blocks.begin() + All.second,
+                                              TargetBlock,
+                                              std::less<const CodeBlock*>());
+        if (detail::classifyExitEdge(*Label, Target, InFunction)) {
+          Exits.emplace_back(It->second, const_cast<CodeBlockType*>(Source));
+        }
+      }
+    }
+
+    std::sort(Exits.begin(), Exits.end());
+    Exits.erase(std::unique(Exits.begin(), Exits.end()), Exits.end());
+    Blocks.reserve(Blocks.size() + Exits.size());
+    for (auto It = Exits.begin(); It != Exits.end();) {
+      uint32_t Fn = It->first;
+      size_t First = Blocks.size();
+      for (; It != Exits.end() && It->first == Fn; ++It) {
+        Blocks.push_back(It->second);
+      }
+      FnSpans[Fn].ExitBlocks = sortSection(Blocks, First);
+    }
+  }
+
+  /// \brief Point the entries at their spans, once the arenas are final
+  void setRanges(const std::vector<Spans>& FnSpans) {
+    auto blocks = [this](const Span& S) {
+      return code_block_range(Blocks.data() + S.first,
+                              Blocks.data() + S.second);
+    };
+    for (size_t I = 0; I < Entries.size(); ++I) {
+      Entries[I].EntryBlocks = blocks(FnSpans[I].EntryBlocks);
+      Entries[I].ExitBlocks = blocks(FnSpans[I].ExitBlocks);
+      Entries[I].AllBlocks = blocks(FnSpans[I].AllBlocks);
+      Entries[I].NameSymbols =
+          symbol_range(Symbols.data() + FnSpans[I].NameSymbols.first,
+                       Symbols.data() + FnSpans[I].NameSymbols.second);
+    }
+  }
+
+  std::vector<CodeBlockType*> Blocks;
+  std::vector<SymbolType*> Symbols;
+  std::vector<Entry> Entries;
+};
+
+} // namespace gtirb
+
+#endif // GTIRB_FN_TABLE_H
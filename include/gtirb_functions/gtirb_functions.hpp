@@ -13,15 +13,34 @@
 //  endorsement should be inferred.
 //
 //===----------------------------------------------------------------------===//
+#include "build_stats.hpp"
+#include "export.hpp"
+#include "local_cfg.hpp"
+#include "symbol_index.hpp"
+#include "uuid_resolver.hpp"
+#include <gtirb/Addr.hpp>
 #include <gtirb/AuxDataSchema.hpp>
 #include <gtirb/Casting.hpp>
 #include <gtirb/Context.hpp>
 #include <gtirb/IR.hpp>
 #include <gtirb/Module.hpp>
 #include <gtirb/Symbol.hpp>
+#include <boost/iterator/iterator_adaptor.hpp>
+#include <boost/iterator/transform_iterator.hpp>
 #include <boost/range.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <type_traits>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -30,10 +49,451 @@
 
 namespace gtirb {
 
+/// \brief When the exit blocks of a \class Function are computed
+enum class ExitBlockMode {
+  Lazy,  ///< On the first call to one of the exit_blocks() accessors
+  Eager, ///< While building, for all functions in one pass over the CFG
+  Skip   ///< Never; the exit block ranges are always empty
+};
+
+/// \brief The ways control can leave a function through an exit block
+///
+/// Values are bit flags, since a block may leave its function in several ways.
+enum class ExitKind : uint8_t {
+  Return = 1 << 0,      ///< Through a return edge
+  Sysret = 1 << 1,      ///< Through a sysret edge
+  TailCall = 1 << 2,    ///< Through any other edge to a code block outside
+                        ///< the function, such as a jump to another
+                        ///< function, or through a direct edge to a proxy
+                        ///< block, such as a jump to an import. This
+                        ///< includes conditional branches and targets that
+                        ///< belong to no function.
+  Fallthrough = 1 << 3, ///< By falling through to a block outside the function
+  Unresolved = 1 << 4   ///< Through an indirect non-call edge to a proxy
+                        ///< block, such as an unresolved indirect jump
+};
+
+/// \brief An exit block, tagged with how control leaves the function there
+template <class CodeBlockType> struct TaggedExitBlock {
+  CodeBlockType* Block;
+
+  /// \brief Bitwise OR of the ExitKind values that apply to the block
+  uint8_t Kinds;
+
+  /// \brief Return whether control leaves the function in way \p K
+  bool is(ExitKind K) const { return (Kinds & static_cast<uint8_t>(K)) != 0; }
+};
+
+/// \brief A block of a function with its address and size, as listed by
+/// Function::blocks_by_address()
+template <class CodeBlockType> struct AddressedBlock {
+  CodeBlockType* Block;
+
+  /// \brief The address of the block, if its byte interval has one
+  std::optional<Addr> Address;
+
+  uint64_t Size;
+};
+
+/// \brief Options controlling how \ref build_functions creates Functions
+struct FunctionBuildOptions {
+  /// \brief The maximum number of threads to use, including the calling
+  /// thread. Zero selects std::thread::hardware_concurrency().
+  unsigned NumThreads = 1;
+
+  /// \brief When to compute exit blocks
+  ExitBlockMode ExitBlocks = ExitBlockMode::Lazy;
+
+  /// \brief Resolved function AuxData to build from, for repeated builds of
+  /// the same module. If null, or built for another module, a temporary one
+  /// is created.
+  const UUIDResolver* Resolver = nullptr;
+
+  /// \brief Where to record timings and counts for the build, see \ref
+  /// FunctionBuildStats. If null, nothing is recorded.
+  FunctionBuildStats* Stats = nullptr;
+};
+
+namespace detail {
+
+/// \brief A value computed on first use and cached
+///
+/// get() is safe to call concurrently. Copies start out empty, so that a
+/// copy made in order to be edited does not inherit stale results.
+template <class T> class LazyValue {
+public:
+  LazyValue() = default;
+  LazyValue(const LazyValue&) {}
+  LazyValue& operator=(const LazyValue&) {
+    reset();
+    return *this;
+  }
+
+  /// \brief Return the value, calling \p Compute to produce it if needed
+  template <class ComputeFn> const T& get(ComputeFn Compute) const {
+    if (!Ready.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      if (!Ready.load(std::memory_order_relaxed)) {
+        Value = Compute();
+        Ready.store(true, std::memory_order_release);
+      }
+    }
+    return Value;
+  }
+
+  /// \brief Store \p V, unless a value has already been computed
+  void set(T V) const {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (!Ready.load(std::memory_order_relaxed)) {
+      Value = std::move(V);
+      Ready.store(true, std::memory_order_release);
+    }
+  }
+
+  /// \brief Return whether the value has been computed
+  bool ready() const { return Ready.load(std::memory_order_acquire); }
+
+  /// \brief Drop the cached value. Not safe to call concurrently with get().
+  void reset() {
+    Ready.store(false, std::memory_order_relaxed);
+    Value = T();
+  }
+
+private:
+  mutable std::mutex Mutex;
+  mutable std::atomic<bool> Ready{false};
+  mutable T Value;
+};
+
+/// \brief Run \p Body(I) for every I in [0, \p Count) on up to \p NumThreads
+/// threads, including the calling one
+///
+/// Threads claim \p ChunkSize consecutive indices at a time. The first
+/// exception thrown by \p Body is rethrown once all threads have stopped.
+template <class BodyType>
+void parallel_for(size_t Count, size_t ChunkSize, unsigned NumThreads,
+                  const BodyType& Body) {
+  std::atomic<size_t> Next{0};
+  std::exception_ptr Error;
+  std::mutex ErrorMutex;
+  auto Worker = [&]() {
+    try {
+      size_t Begin;
+      while ((Begin = Next.fetch_add(ChunkSize)) < Count) {
+        size_t End = std::min(Begin + ChunkSize, Count);
+        for (size_t I = Begin; I < End; ++I) {
+          Body(I);
+        }
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> Lock(ErrorMutex);
+      if (!Error) {
+        Error = std::current_exception();
+      }
+    }
+  };
+
+  size_t NumChunks = (Count + ChunkSize - 1) / ChunkSize;
+  size_t NumWorkers =
+      std::max<size_t>(1, std::min<size_t>(NumThreads, NumChunks));
+  std::vector<std::thread> Threads;
+  Threads.reserve(NumWorkers - 1);
+  for (size_t I = 1; I < NumWorkers; ++I) {
+    Threads.emplace_back(Worker);
+  }
+  Worker();
+  for (auto& Thread : Threads) {
+    Thread.join();
+  }
+  if (Error) {
+    std::rethrow_exception(Error);
+  }
+}
+
+/// \brief Resolves AuxData references for building many functions, through
+/// tables built once for the whole module
+///
+/// Functions are identified by their position in FunctionEntries, which the
+/// resolver has already matched with the other tables; the AuxData
+/// arguments are ignored.
+struct IndexedLookup {
+  const UUIDResolver& Resolver;
+  const SymbolIndex<const Module>& Symbols;
+
+  template <class SetType>
+  void add_entry_blocks(size_t FnIndex, const std::set<UUID>&,
+                        SetType& Blocks) const {
+    auto Range = Resolver.entry_blocks(FnIndex);
+    Blocks.insert(Range.begin(), Range.end());
+  }
+
+  template <class BlocksByFnType, class SetType>
+  void add_blocks(size_t FnIndex, const UUID&, const BlocksByFnType*,
+                  SetType& Blocks) const {
+    auto Range = Resolver.blocks(FnIndex);
+    Blocks.reserve(Range.size());
+    Blocks.insert(Range.begin(), Range.end());
+  }
+
+  template <class FnNamesType>
+  const Symbol* canon_name(size_t FnIndex, const UUID&,
+                           const FnNamesType*) const {
+    return Resolver.name(FnIndex);
+  }
+
+  template <class SetType>
+  void add_names(const CodeBlock* Block, SetType& Names) const {
+    auto Range = Symbols.symbols(Block);
+    Names.insert(Range.begin(), Range.end());
+  }
+};
+
+/// \brief Resolves AuxData references for building a few functions, straight
+/// from the Context and the Module
+///
+/// Functions are identified by their UUID, and the function position is
+/// ignored.
+struct DirectLookup {
+  const Context& C;
+  const Module& Mod;
+
+  template <class SetType>
+  void add_entry_blocks(size_t, const std::set<UUID>& EntryIds,
+                        SetType& Blocks) const {
+    for (const UUID& Id : EntryIds) {
+      if (auto* Block = code_block(Id)) {
+        Blocks.insert(Block);
+      }
+    }
+  }
+
+  template <class BlocksByFnType, class SetType>
+  void add_blocks(size_t, const UUID& FnId, const BlocksByFnType* BlocksByFn,
+                  SetType& Blocks) const {
+    if (!BlocksByFn) {
+      return;
+    }
+    auto It = BlocksByFn->find(FnId);
+    if (It == BlocksByFn->end()) {
+      return;
+    }
+    Blocks.reserve(It->second.size());
+    for (const UUID& Id : It->second) {
+      if (auto* Block = code_block(Id)) {
+        Blocks.insert(Block);
+      }
+    }
+  }
+
+  template <class FnNamesType>
+  const Symbol* canon_name(size_t, const UUID& FnId,
+                           const FnNamesType* FnNames) const {
+    if (!FnNames) {
+      return nullptr;
+    }
+    auto It = FnNames->find(FnId);
+    if (It == FnNames->end()) {
+      return nullptr;
+    }
+    return dyn_cast_or_null<Symbol>(Node::getByUUID(C, It->second));
+  }
+
+  template <class SetType>
+  void add_names(const CodeBlock* Block, SetType& Names) const {
+    for (const Symbol& Sym : Mod.findSymbols(*Block)) {
+      Names.insert(&Sym);
+    }
+  }
+
+private:
+  const CodeBlock* code_block(const UUID& Id) const {
+    return dyn_cast_or_null<CodeBlock>(Node::getByUUID(C, Id));
+  }
+};
+
+/// \brief Classify a CFG edge out of a block of a function
+///
+/// \param Type the type of the edge
+/// \param Direct whether the edge is direct
+/// \param TargetIsCodeBlock whether the target of the edge is a code block,
+/// rather than a proxy block
+/// \param TargetInFunction whether the target is a block of the same function
+///
+/// \return the ExitKind flag for the edge, or zero if the edge stays in the
+/// function or is a call
+inline uint8_t classifyExitEdge(EdgeType Type, DirectEdge Direct,
+                                bool TargetIsCodeBlock,
+                                bool TargetInFunction) {
+  switch (Type) {
+  case EdgeType::Return:
+    return static_cast<uint8_t>(ExitKind::Return);
+  case EdgeType::Sysret:
+    return static_cast<uint8_t>(ExitKind::Sysret);
+  case EdgeType::Call:
+  case EdgeType::Syscall:
+    return 0;
+  default:
+    break;
+  }
+  if (!TargetIsCodeBlock) {
+    // A direct edge to a proxy block has a known target outside the module
+    return static_cast<uint8_t>(Direct == DirectEdge::IsDirect
+                                    ? ExitKind::TailCall
+                                    : ExitKind::Unresolved);
+  }
+  if (TargetInFunction) {
+    return 0;
+  }
+  return static_cast<uint8_t>(Type == EdgeType::Fallthrough
+                                  ? ExitKind::Fallthrough
+                                  : ExitKind::TailCall);
+}
+
+/// \brief Classify a CFG edge labeled \p Label to \p Target out of a block
+/// of a function
+inline uint8_t classifyExitEdge(const EdgeLabel::value_type& Label,
+                                const CfgNode* Target, bool TargetInFunction) {
+  return classifyExitEdge(std::get<EdgeType>(Label),
+                          std::get<DirectEdge>(Label), isa<CodeBlock>(Target),
+                          TargetInFunction);
+}
+
+/// \brief Format the long name of a function with several name symbols,
+/// from its AuxData name \p Canon and its other names \p Aliases
+///
+/// Aliases are listed in sorted order, so the name does not depend on the
+/// order symbols are stored or hashed in.
+inline std::string formatLongName(std::string_view Canon,
+                                  std::vector<std::string_view> Aliases) {
+  std::sort(Aliases.begin(), Aliases.end());
+  const std::string_view Open = " (a.k.a ";
+  const std::string_view Separator = ", ";
+  size_t Size = Canon.size() + Open.size() + 1;
+  for (std::string_view Alias : Aliases) {
+    Size += Alias.size() + Separator.size();
+  }
+
+  std::string LongName;
+  LongName.reserve(Size);
+  LongName += Canon;
+  LongName += Open;
+  for (size_t I = 0; I < Aliases.size(); ++I) {
+    if (I != 0) {
+      LongName += Separator;
+    }
+    LongName += Aliases[I];
+  }
+  LongName += ')';
+  return LongName;
+}
+
+/// \brief Collapse (block, kind) pairs into one entry per block
+inline std::vector<TaggedExitBlock<const CodeBlock>>
+mergeTaggedExits(std::vector<TaggedExitBlock<const CodeBlock>> Exits) {
+  std::sort(Exits.begin(), Exits.end(),
+            [](const auto& A, const auto& B) {
+              return std::less<const CodeBlock*>()(A.Block, B.Block);
+            });
+  std::vector<TaggedExitBlock<const CodeBlock>> Merged;
+  for (const auto& Exit : Exits) {
+    if (!Merged.empty() && Merged.back().Block == Exit.Block) {
+      Merged.back().Kinds |= Exit.Kinds;
+    } else {
+      Merged.push_back(Exit);
+    }
+  }
+  return Merged;
+}
+
+/// \brief Convert a stored tagged exit to the one handed out by
+/// Function<Module>
+struct MakeMutableTaggedExit {
+  TaggedExitBlock<CodeBlock>
+  operator()(const TaggedExitBlock<const CodeBlock>& Exit) const {
+    return {const_cast<CodeBlock*>(Exit.Block), Exit.Kinds};
+  }
+};
+
+/// \brief Convert a stored addressed block to the one handed out by
+/// Function<Module>
+struct MakeMutableAddressedBlock {
+  AddressedBlock<CodeBlock>
+  operator()(const AddressedBlock<const CodeBlock>& Block) const {
+    return {const_cast<CodeBlock*>(Block.Block), Block.Address, Block.Size};
+  }
+};
+
+/// \brief The state behind a \class Function
+///
+/// It is shared, read-only, by all copies of a Function, and by the
+/// Function<Module> and Function<const Module> views of the same function.
+/// Pointers are stored const; Function<Module> only ever wraps data built
+/// from a mutable Module, so it may hand them out as mutable pointers.
+struct FunctionData {
+  using CodeBlockSet = std::unordered_set<const CodeBlock*>;
+  using SymbolSet = std::unordered_set<const Symbol*>;
+
+  UUID Uuid;
+
+  CodeBlockSet EntryBlocks;
+  CodeBlockSet AllBlocks;
+
+  SymbolSet NameSymbols;
+
+  const Symbol* CanonName = nullptr;
+
+  const Module* Mod = nullptr;
+  bool SkipExitBlocks = false;
+
+  /// \brief The exit blocks, both as a set and tagged with their ExitKinds
+  struct ExitBlockInfo {
+    CodeBlockSet Blocks;
+    std::vector<TaggedExitBlock<const CodeBlock>> Tagged;
+  };
+
+  // Computed on demand
+  LazyValue<ExitBlockInfo> Exits;
+  LazyValue<std::string> LongName;
+  LazyValue<LocalCFG> Cfg;
+  LazyValue<std::vector<AddressedBlock<const CodeBlock>>> Layout;
+};
+
+/// \brief Iterator adaptor presenting the const T* elements of \p Base as
+/// T*, for Function<Module>
+template <class Base, class T>
+class mutable_pointer_iterator
+    : public ::boost::iterator_adaptor<mutable_pointer_iterator<Base, T>,
+                                       Base, T*, ::boost::use_default,
+                                       T* const&> {
+public:
+  mutable_pointer_iterator() = default;
+  explicit mutable_pointer_iterator(Base It)
+      : mutable_pointer_iterator::iterator_adaptor_(It) {}
+
+private:
+  friend class ::boost::iterator_core_access;
+
+  // T* and const T* are similar types, so reading one through the other is
+  // well defined.
+  T* const& dereference() const {
+    return const_cast<T* const&>(*this->base());
+  }
+};
+
+} // namespace detail
+
 template <class ModuleType> class Function;
-std::vector<Function<Module>> build_functions(Context& C, Module& M);
-std::vector<Function<const Module>> build_functions(const Context& C,
-                                                    const Module& M);
+template <class ModuleType> struct ModuleFunctions;
+class FunctionCache;
+GTIRB_FUNCTIONS_EXPORT std::vector<Function<Module>>
+build_functions(Context& C, Module& M);
+GTIRB_FUNCTIONS_EXPORT std::vector<Function<const Module>>
+build_functions(const Context& C, const Module& M);
+GTIRB_FUNCTIONS_EXPORT std::vector<Function<Module>>
+build_functions(Context& C, Module& M, const FunctionBuildOptions& Opts);
+GTIRB_FUNCTIONS_EXPORT std::vector<Function<const Module>>
+build_functions(const Context& C, const Module& M,
+                const FunctionBuildOptions& Opts);
 
 /// \class Function<T> serves as a thin wrapper around the function-related
 /// information in AuxData (FunctionEntries, FunctionBlocks, FunctionNames).
@@ -42,6 +502,9 @@ std::vector<Function<const Module>> build_functions(const Context& C,
 /// either Module or const Module. Function<Module> provides mutable access to
 /// its data, while Function<const Module> provides read-only access to its
 /// data.
+///
+/// Copies of a Function share their data, so copying, moving and converting
+/// a Function<Module> to a Function<const Module> take constant time.
 
 template <class ModuleType> class Function {
 
@@ -52,7 +515,23 @@ template <class ModuleType> class Function {
   friend std::vector<Function<Module>> build_functions(Context& C, Module& M);
   friend std::vector<Function<const Module>> build_functions(const Context& C,
                                                              const Module& M);
+  friend std::vector<Function<Module>>
+  build_functions(Context& C, Module& M, const FunctionBuildOptions& Opts);
+  friend std::vector<Function<const Module>>
+  build_functions(const Context& C, const Module& M,
+                  const FunctionBuildOptions& Opts);
+  friend std::vector<ModuleFunctions<Module>>
+  build_functions(Context& C, IR& Ir, const FunctionBuildOptions& Opts);
+  friend std::vector<ModuleFunctions<const Module>>
+  build_functions(const Context& C, const IR& Ir,
+                  const FunctionBuildOptions& Opts);
   template <class Other> friend class Function;
+  template <class Other> friend class FunctionSet;
+  template <class Other> friend class CallGraph;
+  friend class FunctionCache;
+  template <class T>
+  friend void classify_exits(std::vector<Function<T>>& Fns,
+                             FunctionBuildStats* Stats);
 
 public:
   using CodeBlockType = typename std::conditional_t<is_const_module::value,
@@ -63,225 +542,335 @@ public:
   using SymbolSet = typename std::unordered_set<SymbolType*>;
 
 private:
-  UUID Uuid;
+  using CodeBlockStore = detail::FunctionData::CodeBlockSet;
+  using SymbolStore = detail::FunctionData::SymbolSet;
 
-  CodeBlockSet EntryBlocks;
-  CodeBlockSet ExitBlocks;
-  CodeBlockSet AllBlocks;
+  std::shared_ptr<const detail::FunctionData> Data;
 
-  SymbolSet NameSymbols;
+  // helper functions
 
-  SymbolType* CanonName;
-  std::string LongName;
+  using ExitBlockInfo = detail::FunctionData::ExitBlockInfo;
 
-  // helper functions
+  /// \brief Package classified exits as an ExitBlockInfo
+  static ExitBlockInfo
+  makeExitBlockInfo(std::vector<TaggedExitBlock<const CodeBlock>> Tagged) {
+    ExitBlockInfo Info;
+    Info.Tagged = detail::mergeTaggedExits(std::move(Tagged));
+    Info.Blocks.reserve(Info.Tagged.size());
+    for (const auto& Exit : Info.Tagged) {
+      Info.Blocks.insert(Exit.Block);
+    }
+    return Info;
+  }
 
   /// \brief Given the code blocks of a function, return the
   /// subset of blocks that exit the function
-  static CodeBlockSet findExitBlocks(ModuleType& M, CodeBlockSet& Blocks) {
-    /*
-     * Exit blocks are blocks whose outgoing edges are
-     * returns or sysrets;
-     * edges whose target is not in the function, and which are neither
-     * direct calls or syscalls
-     */
-    CodeBlockSet ExitBlocks;
-    auto* Ir = M.getIR();
-    if (!Ir) {
-      return ExitBlocks;
-    }
-    auto Cfg = Ir->getCFG();
-    for (auto& Block : Blocks) {
-      for (auto Succ_pair : cfgSuccessors(Cfg, Block)) {
-        auto [Succ, Edge_label] = Succ_pair;
-        if (Edge_label) {
-          auto& Type = std::get<EdgeType>(*Edge_label);
-          if ((Type == EdgeType::Return) || (Type == EdgeType::Sysret)) {
-            ExitBlocks.insert(Block);
-            break;
-          }
-          if ((Type != EdgeType::Call) && (Type != EdgeType::Syscall)) {
-            auto Dest = dyn_cast<CodeBlockType>(Succ);
-            if ((Dest == nullptr) || (Blocks.find(Dest) == Blocks.end())) {
-              ExitBlocks.insert(Block);
-              break;
-            }
-          }
-        }
+  static ExitBlockInfo findExitBlocks(const Module& M,
+                                      const CodeBlockStore& Blocks);
+
+  /// \brief Format the long name of a function with several name symbols
+  static std::string makeLongName(const detail::FunctionData& D) {
+    // Edited functions may have aliases but no AuxData name
+    const std::string_view Canon =
+        D.CanonName ? std::string_view(D.CanonName->getName()) : "<unknown>";
+    std::vector<std::string_view> Aliases;
+    Aliases.reserve(D.NameSymbols.size());
+    for (const Symbol* Sym : D.NameSymbols) {
+      if (Sym != D.CanonName) {
+        Aliases.push_back(Sym->getName());
       }
     }
-    return ExitBlocks;
+    return detail::formatLongName(Canon, std::move(Aliases));
   }
 
-  void set_name(void) {
-    switch (this->NameSymbols.size()) {
-    case 0:
-      this->LongName = "<unknown>";
-      return;
-    case 1:
-      this->LongName = (*(this->NameSymbols.begin()))->getName();
-      return;
-    default:
-      this->LongName = this->CanonName->getName();
-      this->LongName += " (a.k.a ";
-      std::vector<SymbolType*> otherNames;
-      for (auto& Sym : this->NameSymbols) {
-        if (Sym != this->CanonName) {
-          otherNames.push_back(Sym);
-        }
-      }
-      size_t i = 0;
-      size_t Length = otherNames.size();
-      for (auto& Sym : otherNames) {
-        this->LongName += Sym->getName();
-        if (i + 1 < Length) {
-          this->LongName += ", ";
-        }
-        i += 1;
-      }
-      this->LongName += ')';
+  /// \brief Return the exit blocks, computing them on first use
+  ///
+  /// Safe to call concurrently, including on copies of this Function.
+  const ExitBlockInfo& getExitBlocks() const {
+    const detail::FunctionData* D = Data.get();
+    return D->Exits.get([D]() {
+      return D->SkipExitBlocks ? ExitBlockInfo()
+                               : findExitBlocks(*D->Mod, D->AllBlocks);
+    });
+  }
+
+  /// \brief Return the data for modification, first copying it if it is
+  /// shared with other Functions (copy-on-write). Cached results are dropped.
+  detail::FunctionData& mutableData() {
+    if (Data.use_count() != 1) {
+      Data = std::make_shared<detail::FunctionData>(*Data);
     }
+    // Data is only ever created non-const, by make_shared.
+    auto& D = const_cast<detail::FunctionData&>(*Data);
+    D.Exits.reset();
+    D.LongName.reset();
+    D.Cfg.reset();
+    D.Layout.reset();
+    return D;
   }
 
   // Private constructor;
-  Function(const UUID& Uuid_, const CodeBlockSet& Entries,
-           const CodeBlockSet& Exits, const CodeBlockSet& Blocks,
-           const SymbolSet& Names, SymbolType* canonName = nullptr)
-      : Uuid(Uuid_), EntryBlocks(Entries), ExitBlocks(Exits), AllBlocks(Blocks),
-        NameSymbols(Names), CanonName(canonName) {
-    set_name();
-  };
+  explicit Function(std::shared_ptr<const detail::FunctionData> Data_)
+      : Data(std::move(Data_)){};
 
   //
 
-  /// \brief Create all the functions present in a \ref Module
+  using EntriesByFnType = typename schema::FunctionEntries::Type;
+  using BlocksByFnType = typename schema::FunctionBlocks::Type;
+  using FnNamesType = typename schema::FunctionNames::Type;
+
+  /// \brief Create the function described by a single FunctionEntries entry
   ///
-  /// \param C The current GTIRB \ref Context
-  /// \param Mod The \class Module
+  /// References are resolved through \p Lookup, an \ref
+  /// detail::IndexedLookup, which identifies the function by its position
+  /// \p FnIndex in FunctionEntries, or a \ref detail::DirectLookup, which
+  /// finds it in the AuxData by \p FnId. Only reads from the Module, its IR
+  /// and \p Lookup, so calls for different functions may run concurrently.
+  /// \p Timer, a \ref detail::FunctionPhaseTimer when collecting stats, times
+  /// the block and naming lookups.
+  template <class LookupType, class TimerType = detail::NullPhaseTimer>
+  static Function<ModuleType>
+  build_function(const LookupType& Lookup, ModuleType& Mod, size_t FnIndex,
+                 const UUID& FnId, const std::set<UUID>& FnEntryIds,
+                 const BlocksByFnType* BlocksByFn, const FnNamesType* FnNames,
+                 ExitBlockMode Exits, TimerType Timer = TimerType()) {
+    auto D = std::make_shared<detail::FunctionData>();
+    D->Uuid = FnId;
+    D->Mod = &Mod;
+    D->SkipExitBlocks = (Exits == ExitBlockMode::Skip);
 
-  /// \return an vector containing the Functions in this module, possibly empty
-  static std::vector<Function<ModuleType>> build_functions(ContextType& C,
-                                                           ModuleType& Mod) {
-    auto* EntriesByFn = Mod.template getAuxData<schema::FunctionEntries>();
+    // Look up the function's entry points and blocks
+    Lookup.add_entry_blocks(FnIndex, FnEntryIds, D->EntryBlocks);
+    Lookup.add_blocks(FnIndex, FnId, BlocksByFn, D->AllBlocks);
+    Timer.lap(&detail::FunctionPhaseTimes::Blocks);
 
-    auto* BlocksByFn = Mod.template getAuxData<schema::FunctionBlocks>();
+    // Look up the names of the entry points and the canonical name
+    for (const CodeBlock* FnBlock : D->EntryBlocks) {
+      Lookup.add_names(FnBlock, D->NameSymbols);
+    }
+    D->CanonName = Lookup.canon_name(FnIndex, FnId, FnNames);
+    Timer.lap(&detail::FunctionPhaseTimes::Naming);
 
-    auto* FnNames = Mod.template getAuxData<schema::FunctionNames>();
+    return Function{std::move(D)};
+  }
 
-    std::vector<Function<ModuleType>> Fns;
+  /// \brief Number of functions a worker claims at a time in the parallel
+  /// build. Large enough to amortize the atomic increment, small enough to
+  /// balance uneven function sizes.
+  static constexpr size_t ParallelChunkSize = 64;
 
-    if (EntriesByFn) {
-      for (const auto& FnEntry : *EntriesByFn) {
+  /// \brief Create all the functions present in a \ref Module
+  ///
+  /// \param C The current GTIRB \ref Context
+  /// \param Mod The \class Module
+  /// \param Opts How to build the functions
 
-        auto& [FnId, FnEntryIds] = FnEntry;
-        CodeBlockSet EntryBlocks;
-        SymbolSet NameSymbols;
+  /// \return an vector containing the Functions in this module, possibly empty
+  static std::vector<Function<ModuleType>>
+  build_functions(ContextType& C, ModuleType& Mod,
+                  const FunctionBuildOptions& Opts);
 
-        // Look up the function's entry points and their names
-        for (const auto& Id : FnEntryIds) {
-          auto* FnBlockNode = Node::getByUUID(C, Id);
-          if (auto* FnBlock = dyn_cast_or_null<CodeBlock>(FnBlockNode)) {
-            EntryBlocks.insert(FnBlock);
-            for (auto& s : Mod.findSymbols(*FnBlock)) {
-              NameSymbols.insert(&s);
-            }
-          }
-        }
+  /// \brief Build the functions of \p EntriesByFn, in parallel if there are
+  /// enough of them, timing each one with a timer from \p MakeTimer
+  template <class MakeTimerType>
+  static std::vector<Function<ModuleType>>
+  build_all(const detail::IndexedLookup& Lookup, ModuleType& Mod,
+            const EntriesByFnType& EntriesByFn,
+            const BlocksByFnType* BlocksByFn, const FnNamesType* FnNames,
+            ExitBlockMode Exits, unsigned NumThreads,
+            const MakeTimerType& MakeTimer);
 
-        CodeBlockSet FnBlocks;
-        if (BlocksByFn) {
-          // Look up the function blocks
-          auto FnBlockIdIter = BlocksByFn->find(FnId);
-          if (FnBlockIdIter != BlocksByFn->end()) {
-            auto FnBlockIds = (*FnBlockIdIter).second;
-            for (const auto& Id : FnBlockIds) {
-              if (auto Block =
-                      dyn_cast_or_null<CodeBlock>(Node::getByUUID(C, Id))) {
-                FnBlocks.insert(Block);
-              }
-            }
-          }
-        }
+  /// \brief Add the counts and memory estimates of a finished build to
+  /// \p Stats. Exit blocks are accounted for by classify_exits().
+  ///
+  /// \param Tables the memory held by the lookup tables built for the build
+  static void count_build(FunctionBuildStats& Stats,
+                          const std::vector<Function<ModuleType>>& Fns,
+                          const UUIDResolver& Resolver, uint64_t Tables);
 
-        SymbolType* CanonName = nullptr;
-        if (FnNames) {
-          auto FnNameIter = FnNames->find(FnId);
-          if (FnNameIter != FnNames->end()) {
-            auto Id = (*FnNameIter).second;
-            CanonName = dyn_cast<Symbol>(Symbol::getByUUID(C, Id));
-          }
-        }
+  /// \brief Compute the exit blocks of all of \p Fns in one pass over the
+  /// CFG edges
+  ///
+  /// Functions whose exit blocks are already known, or that were built with
+  /// ExitBlockMode::Skip, are left alone. If \p Stats is given, the time
+  /// taken and the memory held by the new exit blocks are added to it.
+  static void classify_exits(std::vector<Function<ModuleType>>& Fns,
+                             FunctionBuildStats* Stats = nullptr);
 
-        CodeBlockSet ExitBlocks = findExitBlocks(Mod, FnBlocks);
+  /// \brief Build the functions of \p EntriesByFn on up to \p NumThreads
+  /// threads
+  ///
+  /// The result is identical to the serial build: functions appear in
+  /// FunctionEntries order regardless of which thread built them.
+  template <class MakeTimerType>
+  static std::vector<Function<ModuleType>>
+  build_functions_parallel(const detail::IndexedLookup& Lookup,
+                           ModuleType& Mod, const EntriesByFnType& EntriesByFn,
+                           const BlocksByFnType* BlocksByFn,
+                           const FnNamesType* FnNames, ExitBlockMode Exits,
+                           unsigned NumThreads,
+                           const MakeTimerType& MakeTimer);
 
-        Function Fn{FnId,     EntryBlocks, ExitBlocks,
-                    FnBlocks, NameSymbols, CanonName};
-        Fns.push_back(Fn);
-      }
-    }
+  /// \brief Build the functions of every module of \p Ir, see the IR
+  /// overloads of \ref build_functions
+  ///
+  /// The references and symbols of each module are indexed in parallel, one
+  /// module per thread. Then the functions of all the modules are built in
+  /// one parallel loop, so that every thread has work until the last
+  /// function is built, however the functions are spread across modules.
+  template <class IRType>
+  static std::vector<ModuleFunctions<ModuleType>>
+  build_ir_functions(ContextType& C, IRType& Ir,
+                     const FunctionBuildOptions& Opts);
 
-    return Fns;
-  }
+  /// \brief Rebuild the functions saved in \p Cache
+  ///
+  /// \p Nodes holds the node of every UUID in the cache's UUID table, or
+  /// null. Exit blocks and long names are taken from the cache rather than
+  /// recomputed.
+  ///
+  /// \return the functions, or nothing if a UUID does not resolve to a node
+  /// of the expected kind
+  static std::optional<std::vector<Function<ModuleType>>>
+  from_cache(const FunctionCache& Cache, const std::vector<const Node*>& Nodes,
+             ModuleType& Mod);
 
 public:
   /// \brief Copy constructor between Function templates
-  /// Function<U> is constructable from Function<T> if its
-  /// members can be copied
+  /// Function<U> is constructable from Function<T> if a T* converts to a U*.
   /// In practice, this allows a Function<const Module> to be
   /// constructed from Function<Module>, but not the other way around.
-  template <typename T>
-  Function(const Function<T>& F)
-      : Uuid(F.Uuid), EntryBlocks(begin(F.EntryBlocks), end(F.EntryBlocks)),
-        ExitBlocks(begin(F.ExitBlocks), end(F.ExitBlocks)),
-        AllBlocks(begin(F.AllBlocks), end(F.AllBlocks)),
-        NameSymbols(begin(F.NameSymbols), end(F.NameSymbols)),
-        CanonName(F.CanonName), LongName(F.LongName){};
+  /// The new Function shares \p F's data, including computed exit blocks.
+  template <typename T, typename = std::enable_if_t<
+                            std::is_convertible<T*, ModuleType*>::value>>
+  Function(const Function<T>& F) : Data(F.Data){};
 
   /// \section Iterators
 
   /// \brief Iterators over code blocks, in an arbitrary order
-  using code_block_iterator =
-      std::conditional_t<is_const_module::value,
-                         typename CodeBlockSet::const_iterator,
-                         typename CodeBlockSet::iterator>;
+  using code_block_iterator = std::conditional_t<
+      is_const_module::value, typename CodeBlockStore::const_iterator,
+      detail::mutable_pointer_iterator<typename CodeBlockStore::const_iterator,
+                                       CodeBlock>>;
 
   /// \brief Const ranges of code blocks
   using code_block_range = ::boost::iterator_range<code_block_iterator>;
 
   /// \brief Return an iterator to the first entry block
-  code_block_iterator entry_blocks_begin() { return EntryBlocks.begin(); }
+  code_block_iterator entry_blocks_begin() const {
+    return code_block_iterator(Data->EntryBlocks.begin());
+  }
 
   /// \brief Return an iterator to the element after the last entry block
-  code_block_iterator entry_blocks_end() { return EntryBlocks.end(); }
+  code_block_iterator entry_blocks_end() const {
+    return code_block_iterator(Data->EntryBlocks.end());
+  }
 
   /// \brief Return the entry blocks of the function, as a range
-  code_block_range entry_blocks() {
-    return {EntryBlocks.begin(), EntryBlocks.end()};
+  code_block_range entry_blocks() const {
+    return {entry_blocks_begin(), entry_blocks_end()};
   }
 
+  /// Exit blocks are computed from the CFG on the first call to any of the
+  /// exit block accessors, unless the function was built with
+  /// ExitBlockMode::Eager or ExitBlockMode::Skip. They are empty for the
+  /// latter.
+
   /// \brief Return an iterator to the first exit block
-  code_block_iterator exit_blocks_begin() { return ExitBlocks.begin(); }
+  code_block_iterator exit_blocks_begin() const {
+    return code_block_iterator(getExitBlocks().Blocks.begin());
+  }
 
   /// \brief Return an iterator to the element after the last exit block
-  code_block_iterator exit_blocks_end() { return ExitBlocks.end(); }
+  code_block_iterator exit_blocks_end() const {
+    return code_block_iterator(getExitBlocks().Blocks.end());
+  }
 
   /// \brief Return a range of the exit blocks
-  code_block_range exit_blocks() {
-    return {ExitBlocks.begin(), ExitBlocks.end()};
+  code_block_range exit_blocks() const {
+    return {exit_blocks_begin(), exit_blocks_end()};
+  }
+
+  /// \brief An exit block with the ExitKinds that apply to it
+  using TaggedExit = TaggedExitBlock<CodeBlockType>;
+
+  /// \brief Iterators over tagged exit blocks, in an arbitrary order
+  using tagged_exit_iterator = std::conditional_t<
+      is_const_module::value,
+      typename std::vector<TaggedExit>::const_iterator,
+      ::boost::transform_iterator<
+          detail::MakeMutableTaggedExit,
+          std::vector<TaggedExitBlock<const CodeBlock>>::const_iterator>>;
+
+  /// \brief Ranges of tagged exit blocks
+  using tagged_exit_range = ::boost::iterator_range<tagged_exit_iterator>;
+
+  /// \brief Return the exit blocks, each tagged with the ways control leaves
+  /// the function through it
+  tagged_exit_range tagged_exit_blocks() const {
+    auto& Tagged = getExitBlocks().Tagged;
+    return {tagged_exit_iterator(Tagged.begin()),
+            tagged_exit_iterator(Tagged.end())};
   }
 
   /// \brief Return an iterator to the first code block in the function
-  code_block_iterator all_blocks_begin() { return AllBlocks.begin(); }
+  code_block_iterator all_blocks_begin() const {
+    return code_block_iterator(Data->AllBlocks.begin());
+  }
 
   /// \brief Return an iterator to the element after the last code block
-  code_block_iterator all_blocks_end() { return AllBlocks.end(); }
+  code_block_iterator all_blocks_end() const {
+    return code_block_iterator(Data->AllBlocks.end());
+  }
+
+  code_block_range all_blocks() const {
+    return {all_blocks_begin(), all_blocks_end()};
+  }
+
+  /// \brief A block with its address and size
+  using addressed_block = AddressedBlock<CodeBlockType>;
+
+  /// \brief Iterators over addressed blocks, in address order
+  using addressed_block_iterator = std::conditional_t<
+      is_const_module::value, const addressed_block*,
+      ::boost::transform_iterator<detail::MakeMutableAddressedBlock,
+                                  const AddressedBlock<const CodeBlock>*>>;
 
-  code_block_range all_blocks() { return {AllBlocks.begin(), AllBlocks.end()}; }
+  /// \brief Ranges of addressed blocks
+  using addressed_block_range =
+      ::boost::iterator_range<addressed_block_iterator>;
+
+  /// \brief Return the blocks of the function with their addresses and sizes,
+  /// in address order
+  ///
+  /// Blocks without an address come last; ties are broken by UUID, as in
+  /// \ref LocalCFG. The blocks are sorted on first use and then kept in one
+  /// contiguous array, shared between copies, so sweeps over the function's
+  /// bytes need neither sorting nor pointer chasing. Safe to call
+  /// concurrently.
+  addressed_block_range blocks_by_address() const {
+    const detail::FunctionData* D = Data.get();
+    const auto& Layout = D->Layout.get([D]() {
+      std::vector<const CodeBlock*> Sorted(D->AllBlocks.begin(),
+                                           D->AllBlocks.end());
+      std::sort(Sorted.begin(), Sorted.end(), detail::blockAddressOrder);
+      std::vector<AddressedBlock<const CodeBlock>> Blocks;
+      Blocks.reserve(Sorted.size());
+      for (const CodeBlock* Block : Sorted) {
+        Blocks.push_back({Block, Block->getAddress(), Block->getSize()});
+      }
+      return Blocks;
+    });
+    const AddressedBlock<const CodeBlock>* First = Layout.data();
+    return {addressed_block_iterator(First),
+            addressed_block_iterator(First + Layout.size())};
+  }
 
   /// \brief Iterators over symbols, in arbitrary order
-  using symbol_iterator = std::conditional_t<is_const_module::value,
-                                             typename SymbolSet::const_iterator,
-                                             typename SymbolSet::iterator>;
+  using symbol_iterator = std::conditional_t<
+      is_const_module::value, typename SymbolStore::const_iterator,
+      detail::mutable_pointer_iterator<typename SymbolStore::const_iterator,
+                                       Symbol>>;
 
   /// \brief Ranges over symbols
   using symbol_range = typename ::boost::iterator_range<symbol_iterator>;
@@ -289,38 +878,254 @@ public:
   /// A name symbol is any symbol that refers to an entry block of the function
 
   /// \brief Return an iterator to the first symbol for the function name
-  symbol_iterator name_symbols_begin() { return NameSymbols.begin(); }
+  symbol_iterator name_symbols_begin() const {
+    return symbol_iterator(Data->NameSymbols.begin());
+  }
 
   /// \brief Return an iterator to the element after the last symbol for the
   /// function name
-  symbol_iterator name_symbols_end() { return NameSymbols.end(); }
-  symbol_range name_symbols() {
-    return {NameSymbols.begin(), NameSymbols.end()};
+  symbol_iterator name_symbols_end() const {
+    return symbol_iterator(Data->NameSymbols.end());
+  }
+  symbol_range name_symbols() const {
+    return {name_symbols_begin(), name_symbols_end()};
   }
 
   /// \brief Returns the name of the function as recorded in AuxData
-  SymbolType* getName() { return CanonName; }
+  SymbolType* getName() const {
+    return const_cast<SymbolType*>(Data->CanonName);
+  }
 
-  /// \brief Returns a pretty concatenation of the names of the functions,
-  /// as a string view
-  const std::string& getLongName() { return LongName; }
+  /// \brief Returns a pretty concatenation of the names of the functions
+  ///
+  /// The AuxData name comes first, followed by the other names in sorted
+  /// order. Functions with a single name symbol return that symbol's name, so
+  /// only functions with aliases format, and then cache, a new string.
+  const std::string& getLongName() const {
+    static const std::string Unknown = "<unknown>";
+    const detail::FunctionData* D = Data.get();
+    switch (D->NameSymbols.size()) {
+    case 0:
+      return Unknown;
+    case 1:
+      return (*D->NameSymbols.begin())->getName();
+    default:
+      return D->LongName.get([D]() { return makeLongName(*D); });
+    }
+  }
+
+  /// \brief Returns the same name as getLongName(), as a string view
+  std::string_view getLongNameView() const { return getLongName(); }
+
+  /// \brief Returns the name of the function as recorded in AuxData, or an
+  /// empty view if there is none. Never allocates.
+  std::string_view getNameView() const {
+    return Data->CanonName ? std::string_view(Data->CanonName->getName())
+                           : std::string_view();
+  }
 
   /// \brief Returns the UUID of the function
-  const UUID& getUUID() { return Uuid; }
+  const UUID& getUUID() const { return Data->Uuid; }
+
+  /// \brief Returns the function's own part of the CFG, in compressed sparse
+  /// row form
+  ///
+  /// Built from the IR's CFG on first use, then cached and shared between
+  /// copies. Safe to call concurrently.
+  const LocalCFG& local_cfg() const {
+    const detail::FunctionData* D = Data.get();
+    return D->Cfg.get([D]() {
+      const IR* Ir = D->Mod->getIR();
+      return Ir ? LocalCFG(Ir->getCFG(), D->AllBlocks, D->EntryBlocks)
+                : LocalCFG();
+    });
+  }
+
+  /// \section Editing
+  ///
+  /// The editing methods are only available on Function<Module>. Edits are
+  /// copy-on-write: other copies of the function, including
+  /// Function<const Module> ones, keep their contents. Exit blocks, the long
+  /// name and the local CFG are recomputed on next use. The module's AuxData
+  /// is not changed until the edits are committed with a \ref FunctionEdits.
+
+  /// \brief Create a function with UUID \p Id in \p Mod, with no blocks or
+  /// names
+  static Function create(ModuleType& Mod, const UUID& Id) {
+    auto D = std::make_shared<detail::FunctionData>();
+    D->Uuid = Id;
+    D->Mod = &Mod;
+    return Function{std::move(D)};
+  }
+
+  /// \brief Add \p Block to the blocks of the function
+  ///
+  /// \return whether the function changed
+  template <class M = ModuleType>
+  std::enable_if_t<!std::is_const<M>::value, bool> add_block(CodeBlock* Block) {
+    if (Data->AllBlocks.count(Block)) {
+      return false;
+    }
+    mutableData().AllBlocks.insert(Block);
+    return true;
+  }
+
+  /// \brief Remove \p Block from the function, as an entry block too
+  ///
+  /// \return whether the function changed
+  template <class M = ModuleType>
+  std::enable_if_t<!std::is_const<M>::value, bool>
+  remove_block(CodeBlock* Block) {
+    if (!Data->AllBlocks.count(Block) && !Data->EntryBlocks.count(Block)) {
+      return false;
+    }
+    remove_entry_block(Block);
+    mutableData().AllBlocks.erase(Block);
+    return true;
+  }
+
+  /// \brief Make \p Block an entry block of the function, adding it to the
+  /// blocks if needed, and its symbols to the name symbols
+  ///
+  /// \return whether the function changed
+  template <class M = ModuleType>
+  std::enable_if_t<!std::is_const<M>::value, bool>
+  add_entry_block(CodeBlock* Block) {
+    if (Data->EntryBlocks.count(Block)) {
+      return false;
+    }
+    detail::FunctionData& D = mutableData();
+    D.EntryBlocks.insert(Block);
+    D.AllBlocks.insert(Block);
+    for (const Symbol& Sym : D.Mod->findSymbols(*Block)) {
+      D.NameSymbols.insert(&Sym);
+    }
+    return true;
+  }
+
+  /// \brief Stop treating \p Block as an entry block, dropping the name
+  /// symbols that refer to it. The block stays in the function.
+  ///
+  /// \return whether the function changed
+  template <class M = ModuleType>
+  std::enable_if_t<!std::is_const<M>::value, bool>
+  remove_entry_block(CodeBlock* Block) {
+    if (!Data->EntryBlocks.count(Block)) {
+      return false;
+    }
+    detail::FunctionData& D = mutableData();
+    D.EntryBlocks.erase(Block);
+    for (auto It = D.NameSymbols.begin(); It != D.NameSymbols.end();) {
+      if ((*It)->template getReferent<Node>() == Block) {
+        It = D.NameSymbols.erase(It);
+      } else {
+        ++It;
+      }
+    }
+    return true;
+  }
+
+  /// \brief Set the name recorded in AuxData to \p Name, or clear it if
+  /// \p Name is null
+  ///
+  /// \return whether the function changed
+  template <class M = ModuleType>
+  std::enable_if_t<!std::is_const<M>::value, bool> set_name(Symbol* Name) {
+    if (Data->CanonName == Name) {
+      return false;
+    }
+    mutableData().CanonName = Name;
+    return true;
+  }
 };
 
+extern template class GTIRB_FUNCTIONS_EXPORT Function<Module>;
+extern template class GTIRB_FUNCTIONS_EXPORT Function<const Module>;
+
 /// \section Factories for building \class Functions from a \class Module
+///
+/// These are compiled into the library, along with the construction code of
+/// both Function instantiations.
 
 /// \param C the GTIRB context for the module
 /// \param M the Module, either by reference or by constant reference
-std::vector<Function<Module>> build_functions(Context& C, Module& M) {
-  return Function<Module>::build_functions(C, M);
+GTIRB_FUNCTIONS_EXPORT std::vector<Function<Module>>
+build_functions(Context& C, Module& M);
+
+GTIRB_FUNCTIONS_EXPORT std::vector<Function<const Module>>
+build_functions(const Context& C, const Module& M);
+
+/// \brief Variants of the factories above taking \ref FunctionBuildOptions
+///
+/// With more than one thread, functions are returned in the same order as the
+/// serial build. The Module, its IR and the Context must not be modified while
+/// this runs.
+///
+/// \param C the GTIRB context for the module
+/// \param M the Module, either by reference or by constant reference
+/// \param Opts how to build the functions
+GTIRB_FUNCTIONS_EXPORT std::vector<Function<Module>>
+build_functions(Context& C, Module& M, const FunctionBuildOptions& Opts);
+
+GTIRB_FUNCTIONS_EXPORT std::vector<Function<const Module>>
+build_functions(const Context& C, const Module& M,
+                const FunctionBuildOptions& Opts);
+
+/// \brief Compute the exit blocks of all of \p Fns at once
+///
+/// This walks the CFG edges a single time, rather than once per function as
+/// the lazy exit block accessors do. Functions whose exit blocks are already
+/// known are left alone.
+///
+/// \param Fns the functions
+/// \param Stats if not null, where to add the time taken and the memory held
+/// by the exit blocks
+template <class ModuleType>
+void classify_exits(std::vector<Function<ModuleType>>& Fns,
+                    FunctionBuildStats* Stats) {
+  Function<ModuleType>::classify_exits(Fns, Stats);
 }
 
-std::vector<Function<const Module>> build_functions(const Context& C,
-                                                    const Module& M) {
-  return Function<const Module>::build_functions(C, M);
+template <class ModuleType>
+void classify_exits(std::vector<Function<ModuleType>>& Fns) {
+  classify_exits(Fns, nullptr);
 }
 
+/// \brief Build functions on up to \p NumThreads threads (zero means one per
+/// hardware thread), with the default options otherwise
+GTIRB_FUNCTIONS_EXPORT std::vector<Function<Module>>
+build_functions(Context& C, Module& M, unsigned NumThreads);
+
+GTIRB_FUNCTIONS_EXPORT std::vector<Function<const Module>>
+build_functions(const Context& C, const Module& M, unsigned NumThreads);
+
+/// \brief The functions of one module of an IR
+template <class ModuleType> struct ModuleFunctions {
+  ModuleType* Mod;
+  std::vector<Function<ModuleType>> Functions;
+};
+
+/// \brief Build the functions of every module of an IR
+///
+/// Modules are built concurrently, on up to \p Opts.NumThreads threads, each
+/// one with its own UUID resolution and symbol index. Threads take functions
+/// from any module, so an executable and many small libraries keep all the
+/// threads busy as well as a single large module does. The result is the same
+/// for any thread count: one entry per module, in IR::modules() order, each
+/// holding the same functions as a per-module \ref build_functions. With
+/// ExitBlockMode::Eager, exits of all modules are classified in a single pass
+/// over the IR's CFG.
+///
+/// \param C the GTIRB context for the IR
+/// \param Ir the IR, either by reference or by constant reference
+/// \param Opts how to build the functions
+GTIRB_FUNCTIONS_EXPORT std::vector<ModuleFunctions<Module>>
+build_functions(Context& C, IR& Ir,
+                const FunctionBuildOptions& Opts = FunctionBuildOptions());
+
+GTIRB_FUNCTIONS_EXPORT std::vector<ModuleFunctions<const Module>>
+build_functions(const Context& C, const IR& Ir,
+                const FunctionBuildOptions& Opts = FunctionBuildOptions());
+
 }; // namespace gtirb
 #endif
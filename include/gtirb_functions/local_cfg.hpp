@@ -0,0 +1,246 @@
+//===- local_cfg.hpp --------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_FN_LOCAL_CFG_H
+#define GTIRB_FN_LOCAL_CFG_H
+
+#include <gtirb/CFG.hpp>
+#include <gtirb/CodeBlock.hpp>
+#include <boost/range.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace gtirb {
+
+/// \brief The label of a CFG edge, packed into one byte
+struct PackedEdge {
+  uint8_t Bits;
+
+  /// \brief Pack \p Label
+  static PackedEdge pack(const EdgeLabel& Label) {
+    if (!Label) {
+      return {0};
+    }
+    auto [Cond, Direct, Type] = *Label;
+    return {static_cast<uint8_t>(
+        LabeledBit | static_cast<uint8_t>(Type) |
+        (Cond == ConditionalEdge::OnTrue ? ConditionalBit : 0) |
+        (Direct == DirectEdge::IsDirect ? DirectBit : 0))};
+  }
+
+  /// \brief Return whether the edge had a label; if not, the other accessors
+  /// are meaningless
+  bool labeled() const { return Bits & LabeledBit; }
+
+  /// \brief Return the type of the edge
+  EdgeType type() const { return static_cast<EdgeType>(Bits & TypeMask); }
+
+  /// \brief Return whether the edge is taken on a true condition
+  bool conditional() const { return Bits & ConditionalBit; }
+
+  /// \brief Return whether the edge is direct
+  bool direct() const { return Bits & DirectBit; }
+
+  static constexpr uint8_t TypeMask = 0x7;
+  static constexpr uint8_t ConditionalBit = 0x8;
+  static constexpr uint8_t DirectBit = 0x10;
+  static constexpr uint8_t LabeledBit = 0x20;
+};
+
+namespace detail {
+
+/// \brief Order blocks by address, with blocks without an address last, and
+/// then by UUID
+inline bool blockAddressOrder(const CodeBlock* A, const CodeBlock* B) {
+  auto AddrA = A->getAddress();
+  auto AddrB = B->getAddress();
+  if (AddrA.has_value() != AddrB.has_value()) {
+    return AddrA.has_value();
+  }
+  if (AddrA && *AddrA != *AddrB) {
+    return *AddrA < *AddrB;
+  }
+  return A->getUUID() < B->getUUID();
+}
+
+} // namespace detail
+
+/// \class LocalCFG is the CFG of a single function, restricted to edges
+/// between the function's own blocks, in compressed sparse row form.
+///
+/// Blocks are numbered densely from zero, in order of address, with blocks
+/// without an address last; ties are broken by UUID, so the numbering is
+/// deterministic. The successors of block I are
+/// successors(I), with the labels of the matching edges in
+/// successor_edges(I), and likewise for predecessors. Both are flat arrays
+/// of indices, so graph algorithms over a function need neither hashing nor
+/// the IR's adjacency lists.
+///
+/// Edges leaving the function are not included; see
+/// Function::tagged_exit_blocks().
+class LocalCFG {
+public:
+  using index_type = uint32_t;
+
+  /// \brief Range of block indices
+  using index_range = ::boost::iterator_range<const index_type*>;
+
+  /// \brief Range of edge labels, parallel to an index_range
+  using edge_range = ::boost::iterator_range<const PackedEdge*>;
+
+  /// \brief Create an empty graph
+  LocalCFG() : SuccOffsets(1, 0), PredOffsets(1, 0) {}
+
+  /// \brief Build the subgraph of \p Cfg over \p Blocks
+  ///
+  /// \param Cfg the IR's CFG
+  /// \param Blocks the blocks of the function
+  /// \param Entries the entry blocks of the function
+  template <class BlockRange, class EntryRange>
+  LocalCFG(const CFG& Cfg, const BlockRange& Blocks,
+           const EntryRange& Entries) {
+    for (const CodeBlock* Block : Blocks) {
+      Nodes.push_back(Block);
+    }
+    std::sort(Nodes.begin(), Nodes.end(), detail::blockAddressOrder);
+
+    ByPointer.reserve(Nodes.size());
+    for (size_t I = 0; I < Nodes.size(); ++I) {
+      ByPointer.emplace_back(Nodes[I], static_cast<index_type>(I));
+    }
+    std::sort(ByPointer.begin(), ByPointer.end(), pointerOrder);
+
+    for (const CodeBlock* Block : Entries) {
+      if (auto I = index(Block)) {
+        EntryIndices.push_back(*I);
+      }
+    }
+    std::sort(EntryIndices.begin(), EntryIndices.end());
+
+    // Successors, sorted per block for a deterministic layout
+    std::vector<std::pair<index_type, uint8_t>> Out;
+    SuccOffsets.reserve(Nodes.size() + 1);
+    SuccOffsets.push_back(0);
+    for (const CodeBlock* Block : Nodes) {
+      Out.clear();
+      for (auto SuccPair : cfgSuccessors(Cfg, Block)) {
+        auto [Succ, Label] = SuccPair;
+        if (auto J = index(Succ)) {
+          Out.emplace_back(*J, PackedEdge::pack(Label).Bits);
+        }
+      }
+      std::sort(Out.begin(), Out.end());
+      for (auto [J, Bits] : Out) {
+        Succs.push_back(J);
+        SuccEdges.push_back({Bits});
+      }
+      SuccOffsets.push_back(static_cast<index_type>(Succs.size()));
+    }
+
+    // Predecessors, by transposing the successor arrays
+    PredOffsets.assign(Nodes.size() + 1, 0);
+    for (index_type J : Succs) {
+      ++PredOffsets[J + 1];
+    }
+    for (size_t I = 1; I < PredOffsets.size(); ++I) {
+      PredOffsets[I] += PredOffsets[I - 1];
+    }
+    Preds.resize(Succs.size());
+    PredEdges.resize(Succs.size());
+    std::vector<index_type> Fill(PredOffsets.begin(), PredOffsets.end() - 1);
+    for (index_type I = 0; I < Nodes.size(); ++I) {
+      for (index_type E = SuccOffsets[I]; E < SuccOffsets[I + 1]; ++E) {
+        index_type Slot = Fill[Succs[E]]++;
+        Preds[Slot] = I;
+        PredEdges[Slot] = SuccEdges[E];
+      }
+    }
+  }
+
+  /// \brief Return the number of blocks
+  size_t size() const { return Nodes.size(); }
+
+  /// \brief Return the number of edges
+  size_t num_edges() const { return Succs.size(); }
+
+  /// \brief Return the block with index \p I
+  const CodeBlock* block(index_type I) const { return Nodes[I]; }
+
+  /// \brief Return the index of \p Node, if it is a block of the function
+  std::optional<index_type> index(const CfgNode* Node) const {
+    auto It = std::lower_bound(
+        ByPointer.begin(), ByPointer.end(), Node,
+        [](const auto& Entry, const CfgNode* N) {
+          return std::less<const CfgNode*>()(Entry.first, N);
+        });
+    if (It == ByPointer.end() || It->first != Node) {
+      return std::nullopt;
+    }
+    return It->second;
+  }
+
+  /// \brief Return the indices of the entry blocks, in increasing order
+  index_range entries() const {
+    return {EntryIndices.data(), EntryIndices.data() + EntryIndices.size()};
+  }
+
+  /// \brief Return the successors of block \p I, in increasing order
+  index_range successors(index_type I) const {
+    return {Succs.data() + SuccOffsets[I], Succs.data() + SuccOffsets[I + 1]};
+  }
+
+  /// \brief Return the labels of the edges to successors(\p I)
+  edge_range successor_edges(index_type I) const {
+    return {SuccEdges.data() + SuccOffsets[I],
+            SuccEdges.data() + SuccOffsets[I + 1]};
+  }
+
+  /// \brief Return the predecessors of block \p I, in increasing order
+  index_range predecessors(index_type I) const {
+    return {Preds.data() + PredOffsets[I], Preds.data() + PredOffsets[I + 1]};
+  }
+
+  /// \brief Return the labels of the edges from predecessors(\p I)
+  edge_range predecessor_edges(index_type I) const {
+    return {PredEdges.data() + PredOffsets[I],
+            PredEdges.data() + PredOffsets[I + 1]};
+  }
+
+private:
+  static bool pointerOrder(const std::pair<const CfgNode*, index_type>& A,
+                           const std::pair<const CfgNode*, index_type>& B) {
+    return std::less<const CfgNode*>()(A.first, B.first);
+  }
+
+  std::vector<const CodeBlock*> Nodes;
+  std::vector<std::pair<const CfgNode*, index_type>> ByPointer;
+  std::vector<index_type> EntryIndices;
+
+  std::vector<index_type> SuccOffsets;
+  std::vector<index_type> Succs;
+  std::vector<PackedEdge> SuccEdges;
+
+  std::vector<index_type> PredOffsets;
+  std::vector<index_type> Preds;
+  std::vector<PackedEdge> PredEdges;
+};
+
+} // namespace gtirb
+
+#endif // GTIRB_FN_LOCAL_CFG_H
@@ -0,0 +1,125 @@
+//===- name_pool.hpp --------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_FN_NAME_POOL_H
+#define GTIRB_FN_NAME_POOL_H
+
+#include "gtirb_functions.hpp"
+#include <boost/range.hpp>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace gtirb {
+
+/// \class NamePool interns the names of the functions of a module.
+///
+/// Each distinct function name gets a dense \ref NameId, so names can be
+/// compared and hashed as integers, and used to index plain arrays. IDs are
+/// assigned in order of first appearance in the function vector the pool was
+/// built from, so the same module always yields the same IDs.
+///
+/// A function's name is the one recorded in the FunctionNames AuxData (see
+/// Function::getNameView()). Names are not copied: the pool holds views of
+/// the symbols' names, which must not be renamed or destroyed while the pool
+/// is in use.
+class NamePool {
+public:
+  /// \brief The ID of an interned name
+  using NameId = uint32_t;
+
+  /// \brief The ID of functions without a name
+  static constexpr NameId NoName = UINT32_MAX;
+
+  /// \brief Iterator over the indices of the functions with a name
+  using index_iterator = const size_t*;
+
+  /// \brief Range of indices of the functions with a name
+  using index_range = ::boost::iterator_range<index_iterator>;
+
+  /// \brief Intern the names of \p Fns
+  template <class ModuleType>
+  explicit NamePool(const std::vector<Function<ModuleType>>& Fns) {
+    FunctionNames.reserve(Fns.size());
+    for (const auto& Fn : Fns) {
+      std::string_view Name = Fn.getNameView();
+      if (!Fn.getName()) {
+        FunctionNames.push_back(NoName);
+        continue;
+      }
+      auto [It, Inserted] =
+          Ids.try_emplace(Name, static_cast<NameId>(Names.size()));
+      if (Inserted) {
+        Names.push_back(Name);
+      }
+      FunctionNames.push_back(It->second);
+    }
+
+    // Group function indices by name, in increasing order within a name.
+    Offsets.assign(Names.size() + 1, 0);
+    for (NameId Id : FunctionNames) {
+      if (Id != NoName) {
+        ++Offsets[Id + 1];
+      }
+    }
+    for (size_t I = 1; I < Offsets.size(); ++I) {
+      Offsets[I] += Offsets[I - 1];
+    }
+    Owners.resize(Offsets.back());
+    std::vector<size_t> Fill(Offsets.begin(), Offsets.end() - 1);
+    for (size_t I = 0; I < FunctionNames.size(); ++I) {
+      if (FunctionNames[I] != NoName) {
+        Owners[Fill[FunctionNames[I]]++] = I;
+      }
+    }
+  }
+
+  /// \brief Return the number of distinct names
+  size_t size() const { return Names.size(); }
+
+  /// \brief Return the name with ID \p Id
+  std::string_view name(NameId Id) const { return Names[Id]; }
+
+  /// \brief Return the ID of \p Name, if it is the name of a function
+  std::optional<NameId> find(std::string_view Name) const {
+    auto It = Ids.find(Name);
+    if (It == Ids.end()) {
+      return std::nullopt;
+    }
+    return It->second;
+  }
+
+  /// \brief Return the name ID of the function at position \p I, or NoName
+  NameId name_id(size_t I) const { return FunctionNames[I]; }
+
+  /// \brief Return the positions of the functions named \p Id, in increasing
+  /// order
+  index_range functions(NameId Id) const {
+    return {Owners.data() + Offsets[Id], Owners.data() + Offsets[Id + 1]};
+  }
+
+private:
+  std::vector<std::string_view> Names;
+  std::unordered_map<std::string_view, NameId> Ids;
+  std::vector<NameId> FunctionNames;
+
+  std::vector<size_t> Offsets;
+  std::vector<size_t> Owners;
+};
+
+} // namespace gtirb
+
+#endif // GTIRB_FN_NAME_POOL_H
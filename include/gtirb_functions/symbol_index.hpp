@@ -0,0 +1,123 @@
+//===- symbol_index.hpp -----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_FN_SYMBOL_INDEX_H
+#define GTIRB_FN_SYMBOL_INDEX_H
+
+#include "build_stats.hpp"
+#include <gtirb/Module.hpp>
+#include <gtirb/Node.hpp>
+#include <gtirb/Symbol.hpp>
+#include <boost/range.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gtirb {
+
+/// \class SymbolIndex<T> maps nodes to the symbols of a module that refer to
+/// them.
+///
+/// The index is built in a single pass over Module::symbols(). All symbols
+/// are stored in one array, grouped by referent, so looking up a referent is
+/// one hash lookup that yields a contiguous range. Within a range, symbols
+/// keep their order in Module::symbols().
+///
+/// This answers the same question as Module::findSymbols(), and is cheaper
+/// when many referents are looked up, as when building all the functions of a
+/// module. The index must be rebuilt after symbols are added, removed or
+/// retargeted.
+template <class ModuleType> class SymbolIndex {
+public:
+  using SymbolType =
+      std::conditional_t<std::is_const<ModuleType>::value, const Symbol,
+                         Symbol>;
+
+  /// \brief Iterators over symbols
+  using symbol_iterator = SymbolType* const*;
+
+  /// \brief Ranges over symbols
+  using symbol_range = ::boost::iterator_range<symbol_iterator>;
+
+  /// \brief Create an empty index
+  SymbolIndex() = default;
+
+  /// \brief Index the symbols of \p M
+  explicit SymbolIndex(ModuleType& M) {
+    std::vector<std::pair<const Node*, SymbolType*>> ByReferent;
+    for (auto& S : M.symbols()) {
+      if (const Node* Referent = S.template getReferent<Node>()) {
+        ByReferent.emplace_back(Referent, &S);
+      }
+    }
+    std::stable_sort(ByReferent.begin(), ByReferent.end(),
+                     [](const auto& A, const auto& B) {
+                       return std::less<const Node*>()(A.first, B.first);
+                     });
+
+    Symbols.reserve(ByReferent.size());
+    for (const auto& [Referent, S] : ByReferent) {
+      auto [It, Inserted] = Spans.try_emplace(
+          Referent, Span{static_cast<uint32_t>(Symbols.size()), 0});
+      (void)Inserted;
+      Symbols.push_back(S);
+      ++It->second.Count;
+    }
+  }
+
+  /// \brief Return the symbols referring to \p Referent
+  symbol_range symbols(const Node* Referent) const {
+    auto It = Spans.find(Referent);
+    if (It == Spans.end()) {
+      return symbol_range();
+    }
+    symbol_iterator First = Symbols.data() + It->second.Offset;
+    return {First, First + It->second.Count};
+  }
+
+  /// \brief Return the symbols referring to \p Referent
+  symbol_range symbols(const Node& Referent) const {
+    return symbols(&Referent);
+  }
+
+  /// \brief Return the number of distinct referents
+  size_t size() const { return Spans.size(); }
+
+  /// \brief Return whether no symbol has a referent
+  bool empty() const { return Spans.empty(); }
+
+  /// \brief Return an estimate of the memory held by the index, in bytes
+  uint64_t memory_usage() const {
+    return sizeof(*this) + detail::vectorBytes(Symbols) +
+           detail::unorderedBytes(Spans);
+  }
+
+private:
+  /// \brief A run of symbols in Symbols
+  struct Span {
+    uint32_t Offset;
+    uint32_t Count;
+  };
+
+  std::vector<SymbolType*> Symbols;
+  std::unordered_map<const Node*, Span> Spans;
+};
+
+} // namespace gtirb
+
+#endif // GTIRB_FN_SYMBOL_INDEX_H
@@ -0,0 +1,229 @@
+//===- uuid_resolver.hpp ----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_FN_UUID_RESOLVER_H
+#define GTIRB_FN_UUID_RESOLVER_H
+
+#include "build_stats.hpp"
+#include <gtirb/AuxDataSchema.hpp>
+#include <gtirb/Casting.hpp>
+#include <gtirb/CodeBlock.hpp>
+#include <gtirb/Context.hpp>
+#include <gtirb/Module.hpp>
+#include <gtirb/Node.hpp>
+#include <gtirb/Symbol.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace gtirb {
+
+/// \class UUIDResolver resolves, in one pass, every UUID that the function
+/// AuxData tables of a module refer to.
+///
+/// Each reference in FunctionEntries, FunctionBlocks and FunctionNames is
+/// looked up in the \ref Context once, in table order, and the nodes are
+/// stored by function in the order of FunctionEntries: the entry blocks and
+/// function blocks of each function as adjacent runs of one flat array, and
+/// its name. Building a function then copies a run of pointers instead of
+/// looking up any UUID.
+///
+/// References that do not resolve to a node of the expected kind (a \ref
+/// CodeBlock for entries and blocks, a \ref Symbol for names) are recorded as
+/// dangling, rather than dropped silently.
+///
+/// A resolver may be passed to \ref build_functions through \ref
+/// FunctionBuildOptions and reused across calls on the same module. It must be
+/// rebuilt after the module's function AuxData, or the nodes it refers to,
+/// change.
+class UUIDResolver {
+public:
+  /// \brief The AuxData table a reference comes from
+  enum class Table { FunctionEntries, FunctionBlocks, FunctionNames };
+
+  /// \brief A reference in a function AuxData table that could not be
+  /// resolved
+  struct DanglingReference {
+    /// \brief The function whose entry holds the reference
+    UUID Function;
+
+    /// \brief The unresolved UUID
+    UUID Id;
+
+    /// \brief The table holding the reference
+    Table Source;
+  };
+
+  /// \brief Ranges of resolved code blocks
+  using code_block_range = ::boost::iterator_range<const CodeBlock* const*>;
+
+  /// \brief Create an empty resolver, which resolves nothing
+  UUIDResolver() = default;
+
+  /// \brief Create a resolver for the function AuxData of \p M
+  UUIDResolver(const Context& C, const Module& M) { rebuild(C, M); }
+
+  /// \brief Discard the current contents and resolve the function AuxData of
+  /// \p M again
+  void rebuild(const Context& C, const Module& M) {
+    Mod = &M;
+    Functions.clear();
+    Blocks.clear();
+    Dangling.clear();
+
+    auto* EntriesByFn = M.getAuxData<schema::FunctionEntries>();
+    auto* BlocksByFn = M.getAuxData<schema::FunctionBlocks>();
+    auto* FnNames = M.getAuxData<schema::FunctionNames>();
+
+    // Tables are std::maps keyed by function, so functions come out in
+    // FunctionEntries order, and the other tables can be matched to them by
+    // walking both in step. The dangling report is sorted by table, then
+    // function.
+    if (EntriesByFn) {
+      Functions.reserve(EntriesByFn->size());
+      for (const auto& [FnId, EntryIds] : *EntriesByFn) {
+        Refs R;
+        R.Id = FnId;
+        R.EntryBegin = static_cast<uint32_t>(Blocks.size());
+        for (const UUID& Id : EntryIds) {
+          if (auto* Block = codeBlock(C, Id)) {
+            Blocks.push_back(Block);
+          } else {
+            Dangling.push_back({FnId, Id, Table::FunctionEntries});
+          }
+        }
+        R.EntryEnd = static_cast<uint32_t>(Blocks.size());
+        Functions.push_back(R);
+      }
+    }
+    if (BlocksByFn) {
+      size_t I = 0;
+      for (const auto& [FnId, BlockIds] : *BlocksByFn) {
+        Refs* R = match(I, FnId);
+        uint32_t Begin = static_cast<uint32_t>(Blocks.size());
+        for (const UUID& Id : BlockIds) {
+          if (auto* Block = codeBlock(C, Id)) {
+            if (R) {
+              Blocks.push_back(Block);
+            }
+          } else {
+            Dangling.push_back({FnId, Id, Table::FunctionBlocks});
+          }
+        }
+        if (R) {
+          R->BlockBegin = Begin;
+          R->BlockEnd = static_cast<uint32_t>(Blocks.size());
+        }
+      }
+    }
+    if (FnNames) {
+      size_t I = 0;
+      for (const auto& [FnId, NameId] : *FnNames) {
+        auto* Name = dyn_cast_or_null<Symbol>(Node::getByUUID(C, NameId));
+        if (!Name) {
+          Dangling.push_back({FnId, NameId, Table::FunctionNames});
+        } else if (Refs* R = match(I, FnId)) {
+          R->Name = Name;
+        }
+      }
+    }
+  }
+
+  /// \brief Return the module the resolver was built for, or null
+  const Module* module() const { return Mod; }
+
+  /// \brief Return the number of functions in FunctionEntries when the
+  /// resolver was built
+  size_t size() const { return Functions.size(); }
+
+  /// \brief Return whether the resolver was built for \p M, and \p M still
+  /// has as many functions as when it was
+  ///
+  /// Functions are looked up by position, so a resolver that fails this
+  /// check must not be used for \p M. Passing it does not prove the resolver
+  /// is current; see \ref rebuild.
+  bool covers(const Module& M) const {
+    if (Mod != &M) {
+      return false;
+    }
+    auto* EntriesByFn = M.getAuxData<schema::FunctionEntries>();
+    return (EntriesByFn ? EntriesByFn->size() : 0) == Functions.size();
+  }
+
+  /// \brief Return the UUID of the function at position \p Fn of
+  /// FunctionEntries
+  const UUID& function(size_t Fn) const { return Functions[Fn].Id; }
+
+  /// \brief Return the entry blocks of the function at position \p Fn of
+  /// FunctionEntries that resolved
+  code_block_range entry_blocks(size_t Fn) const {
+    const Refs& R = Functions[Fn];
+    return {Blocks.data() + R.EntryBegin, Blocks.data() + R.EntryEnd};
+  }
+
+  /// \brief Return the FunctionBlocks blocks of the function at position
+  /// \p Fn of FunctionEntries that resolved
+  code_block_range blocks(size_t Fn) const {
+    const Refs& R = Functions[Fn];
+    return {Blocks.data() + R.BlockBegin, Blocks.data() + R.BlockEnd};
+  }
+
+  /// \brief Return the FunctionNames symbol of the function at position
+  /// \p Fn of FunctionEntries, or null
+  const Symbol* name(size_t Fn) const { return Functions[Fn].Name; }
+
+  /// \brief Return the references that did not resolve, ordered by table and
+  /// then by function
+  const std::vector<DanglingReference>& dangling() const { return Dangling; }
+
+  /// \brief Return an estimate of the memory held by the resolver, in bytes
+  uint64_t memory_usage() const {
+    return sizeof(*this) + detail::vectorBytes(Functions) +
+           detail::vectorBytes(Blocks) + detail::vectorBytes(Dangling);
+  }
+
+private:
+  /// \brief The resolved references of one function
+  struct Refs {
+    UUID Id;
+    uint32_t EntryBegin = 0;
+    uint32_t EntryEnd = 0;
+    uint32_t BlockBegin = 0;
+    uint32_t BlockEnd = 0;
+    const Symbol* Name = nullptr;
+  };
+
+  static const CodeBlock* codeBlock(const Context& C, const UUID& Id) {
+    return dyn_cast_or_null<CodeBlock>(Node::getByUUID(C, Id));
+  }
+
+  /// \brief Advance \p I through the functions to \p FnId, which tables
+  /// visit in increasing order, and return its references if it has any
+  Refs* match(size_t& I, const UUID& FnId) {
+    while (I < Functions.size() && Functions[I].Id < FnId) {
+      ++I;
+    }
+    return I < Functions.size() && Functions[I].Id == FnId ? &Functions[I]
+                                                           : nullptr;
+  }
+
+  const Module* Mod = nullptr;
+  std::vector<Refs> Functions;
+  std::vector<const CodeBlock*> Blocks;
+  std::vector<DanglingReference> Dangling;
+};
+
+} // namespace gtirb
+
+#endif // GTIRB_FN_UUID_RESOLVER_H
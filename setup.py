@@ -11,6 +11,7 @@
 # endorsement should be inferred.
 #
 import imp
+import os
 import unittest
 import setuptools
 
@@ -26,6 +27,26 @@ def gtirb_functions_test_suite():
     return test_suite
 
 
+def native_extensions():
+    """The compiled extension, built against the C++ headers in include/ and
+    an installed GTIRB. It is optional: if it fails to build, the package
+    falls back to pure Python. Set GTIRB_FUNCTIONS_NO_NATIVE to skip it."""
+
+    if os.environ.get("GTIRB_FUNCTIONS_NO_NATIVE"):
+        return []
+    return [
+        setuptools.Extension(
+            "gtirb_functions._native",
+            sources=["src/python/native.cpp", "src/gtirb_functions.cpp"],
+            include_dirs=["include"],
+            libraries=["gtirb"],
+            language="c++",
+            extra_compile_args=["-std=c++17"],
+            optional=True,
+        )
+    ]
+
+
 if __name__ == "__main__":
     with open("README.md", "r") as fh:
         long_description = fh.read()
@@ -38,6 +59,7 @@ if __name__ == "__main__":
         description="Utilities for dealing with functions in GTIRB",
         packages=setuptools.find_packages(),
         package_data={"gtirb_functions": ["py.typed"]},
+        ext_modules=native_extensions(),
         test_suite="setup.gtirb_functions_test_suite",
         install_requires=["gtirb"],
         classifiers=["Programming Language :: Python :: 3"],
@@ -0,0 +1,406 @@
+#include "gtirb_functions/block_membership.hpp"
+#include "gtirb_functions/function_table.hpp"
+#include "gtirb_functions/gtirb_functions.hpp"
+#include <gtirb/gtirb.hpp>
+#include <benchmark/benchmark.h>
+#include <boost/uuid/uuid_generators.hpp>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+using namespace gtirb;
+
+/// \brief The shape of a synthetic module
+struct ModuleShape {
+  /// \brief Number of functions
+  size_t Functions;
+
+  /// \brief Number of blocks owned by each function
+  size_t BlocksPerFunction = 8;
+
+  /// \brief Fraction of each function's blocks that also belong to the next
+  /// function
+  double SharedBlockRatio = 0.05;
+
+  /// \brief Extra CFG edges per block, on top of the fallthrough chain
+  double EdgeDensity = 1.0;
+
+  bool operator==(const ModuleShape& Other) const {
+    return std::tie(Functions, BlocksPerFunction, SharedBlockRatio,
+                    EdgeDensity) == std::tie(Other.Functions,
+                                             Other.BlocksPerFunction,
+                                             Other.SharedBlockRatio,
+                                             Other.EdgeDensity);
+  }
+};
+
+/// \brief A synthetic IR with one module and its function AuxData
+///
+/// The same shape always yields the same CFG and AuxData: every random choice
+/// comes from a generator with a fixed seed, and UUIDs are derived from it.
+class SyntheticIR {
+public:
+  explicit SyntheticIR(const ModuleShape& Shape) {
+    std::mt19937_64 Rng(0x6774697262);
+    boost::uuids::basic_random_generator<std::mt19937_64> Uuids(Rng);
+
+    Ir = IR::Create(Ctx);
+    Mod = Module::Create(Ctx, "bench");
+    Ir->addModule(Mod);
+    auto* Sec = Section::Create(Ctx, ".text");
+    Mod->addSection(Sec);
+    size_t NumBlocks = Shape.Functions * Shape.BlocksPerFunction;
+    auto* Interval =
+        ByteInterval::Create(Ctx, std::make_optional(Addr(0x10000)), 0);
+    Sec->addByteInterval(Interval);
+
+    std::vector<CodeBlock*> Blocks;
+    Blocks.reserve(NumBlocks);
+    for (size_t I = 0; I < NumBlocks; ++I) {
+      auto* Block = CodeBlock::Create(Ctx, 4);
+      Interval->addBlock(4 * I, Block);
+      Blocks.push_back(Block);
+    }
+    auto* Unknown = ProxyBlock::Create(Ctx);
+
+    auto& Cfg = Ir->getCFG();
+    auto addEdgeOf = [&](CfgNode* Src, CfgNode* Dst, EdgeType Type,
+                         DirectEdge Direct = DirectEdge::IsDirect) {
+      addVertex(Src, Cfg);
+      addVertex(Dst, Cfg);
+      if (auto Edge = gtirb::addEdge(Src, Dst, Cfg)) {
+        Cfg[*Edge] =
+            EdgeLabel{std::tuple{ConditionalEdge::OnFalse, Direct, Type}};
+      }
+    };
+
+    schema::FunctionEntries::Type Entries;
+    schema::FunctionBlocks::Type FnBlocks;
+    schema::FunctionNames::Type Names;
+
+    size_t B = Shape.BlocksPerFunction;
+    // Round up, so that any positive ratio shares at least one block
+    size_t Shared = std::min(
+        B, static_cast<size_t>(std::ceil(Shape.SharedBlockRatio * B)));
+    std::uniform_real_distribution<double> Unit(0.0, 1.0);
+    std::uniform_int_distribution<size_t> AnyFunction(0, Shape.Functions - 1);
+    std::uniform_int_distribution<size_t> AnyBlock(0, B - 1);
+    for (size_t F = 0; F < Shape.Functions; ++F) {
+      UUID Id = Uuids();
+      CodeBlock** Own = Blocks.data() + F * B;
+
+      Entries[Id].insert(Own[0]->getUUID());
+      for (size_t I = 0; I < B; ++I) {
+        FnBlocks[Id].insert(Own[I]->getUUID());
+      }
+      // Share the first blocks of the next function
+      if (F + 1 < Shape.Functions) {
+        for (size_t I = 0; I < Shared; ++I) {
+          FnBlocks[Id].insert(Own[B + I]->getUUID());
+        }
+      }
+      auto* Name = Symbol::Create(Ctx, Own[0], "fn_" + std::to_string(F));
+      Mod->addSymbol(Name);
+      Names[Id] = Name->getUUID();
+
+      for (size_t I = 0; I + 1 < B; ++I) {
+        addEdgeOf(Own[I], Own[I + 1], EdgeType::Fallthrough);
+      }
+      addEdgeOf(Own[B - 1], Unknown, EdgeType::Return);
+
+      // Extra edges: mostly local branches, plus calls, tail calls and
+      // unresolved jumps
+      size_t Extra = static_cast<size_t>(Shape.EdgeDensity * B);
+      for (size_t E = 0; E < Extra; ++E) {
+        CodeBlock* Src = Own[AnyBlock(Rng)];
+        double Kind = Unit(Rng);
+        if (Kind < 0.7) {
+          addEdgeOf(Src, Own[AnyBlock(Rng)], EdgeType::Branch);
+        } else if (Kind < 0.9) {
+          addEdgeOf(Src, Blocks[AnyFunction(Rng) * B], EdgeType::Call);
+        } else if (Kind < 0.97) {
+          addEdgeOf(Src, Blocks[AnyFunction(Rng) * B], EdgeType::Branch);
+        } else {
+          addEdgeOf(Src, Unknown, EdgeType::Branch, DirectEdge::IsIndirect);
+        }
+      }
+    }
+
+    Mod->addAuxData<schema::FunctionEntries>(std::move(Entries));
+    Mod->addAuxData<schema::FunctionBlocks>(std::move(FnBlocks));
+    Mod->addAuxData<schema::FunctionNames>(std::move(Names));
+  }
+
+  Context Ctx;
+  IR* Ir;
+  Module* Mod;
+};
+
+/// \brief Return the shape given by the arguments of a benchmark: the
+/// number of functions, blocks per function, shared blocks as a percentage
+/// of a function's blocks, and extra edges per block as a percentage
+static ModuleShape shapeOf(const benchmark::State& State) {
+  ModuleShape Shape;
+  Shape.Functions = static_cast<size_t>(State.range(0));
+  Shape.BlocksPerFunction = static_cast<size_t>(State.range(1));
+  Shape.SharedBlockRatio = State.range(2) / 100.0;
+  Shape.EdgeDensity = State.range(3) / 100.0;
+  return Shape;
+}
+
+/// \brief Return the synthetic IR with the shape given by the arguments of
+/// \p State, generating it on first use. Generation dominates the cost of
+/// the small benchmarks, so the IR is kept across the repetitions of a
+/// benchmark; only the most recent shape is kept, since the largest ones take
+/// gigabytes.
+static SyntheticIR& syntheticIR(const benchmark::State& State) {
+  static std::optional<ModuleShape> CachedShape;
+  static std::unique_ptr<SyntheticIR> Cached;
+  ModuleShape Shape = shapeOf(State);
+  if (!(CachedShape == Shape)) {
+    // Free the previous IR before building the next one
+    Cached.reset();
+    Cached = std::make_unique<SyntheticIR>(Shape);
+    CachedShape = Shape;
+  }
+  return *Cached;
+}
+
+static void setCounters(benchmark::State& State) {
+  State.SetItemsProcessed(State.iterations() * State.range(0));
+  State.counters["functions"] = static_cast<double>(State.range(0));
+}
+
+static void BM_BuildFunctions(benchmark::State& State) {
+  auto& S = syntheticIR(State);
+  for (auto _ : State) {
+    auto Fns = build_functions(S.Ctx, *S.Mod);
+    benchmark::DoNotOptimize(Fns.data());
+  }
+  setCounters(State);
+}
+
+/// \brief Resolve the entry blocks, blocks and canonical name of every
+/// function of \p M through \p Lookup, as build_function does, returning how
+/// many resolved
+template <class LookupType>
+static size_t resolveReferences(const Module& M, const LookupType& Lookup) {
+  auto* BlocksByFn = M.getAuxData<schema::FunctionBlocks>();
+  auto* FnNames = M.getAuxData<schema::FunctionNames>();
+  size_t Count = 0;
+  size_t FnIndex = 0;
+  auto* EntriesByFn = M.getAuxData<schema::FunctionEntries>();
+  for (const auto& [FnId, EntryIds] : *EntriesByFn) {
+    std::unordered_set<const CodeBlock*> Entries, Blocks;
+    Lookup.add_entry_blocks(FnIndex, EntryIds, Entries);
+    Lookup.add_blocks(FnIndex, FnId, BlocksByFn, Blocks);
+    Count += Entries.size() + Blocks.size() +
+             (Lookup.canon_name(FnIndex, FnId, FnNames) != nullptr);
+    ++FnIndex;
+  }
+  return Count;
+}
+
+static void BM_ResolveDirect(benchmark::State& State) {
+  auto& S = syntheticIR(State);
+  for (auto _ : State) {
+    detail::DirectLookup Lookup{S.Ctx, *S.Mod};
+    benchmark::DoNotOptimize(resolveReferences(*S.Mod, Lookup));
+  }
+  setCounters(State);
+}
+
+static void BM_ResolveBatched(benchmark::State& State) {
+  auto& S = syntheticIR(State);
+  // Names are not resolved, so the symbol index is not part of the cost
+  const SymbolIndex<const Module> Symbols(*S.Mod);
+  for (auto _ : State) {
+    UUIDResolver Resolver(S.Ctx, *S.Mod);
+    detail::IndexedLookup Lookup{Resolver, Symbols};
+    benchmark::DoNotOptimize(resolveReferences(*S.Mod, Lookup));
+  }
+  setCounters(State);
+}
+
+static void BM_BuildFunctionTable(benchmark::State& State) {
+  auto& S = syntheticIR(State);
+  uint64_t Bytes = 0;
+  for (auto _ : State) {
+    FunctionTable<Module> Table(S.Ctx, *S.Mod);
+    Bytes = Table.memory_usage();
+    benchmark::DoNotOptimize(Table.begin());
+  }
+  setCounters(State);
+  // Compare with the result_bytes of functions built with exits
+  State.counters["bytes"] = static_cast<double>(Bytes);
+}
+
+static void BM_BuildFunctionsWithExits(benchmark::State& State) {
+  auto& S = syntheticIR(State);
+  FunctionBuildOptions Opts;
+  Opts.ExitBlocks = ExitBlockMode::Eager;
+  FunctionBuildStats Stats;
+  for (auto _ : State) {
+    Stats = FunctionBuildStats();
+    Opts.Stats = &Stats;
+    auto Fns = build_functions(S.Ctx, *S.Mod, Opts);
+    benchmark::DoNotOptimize(Fns.data());
+  }
+  setCounters(State);
+  State.counters["bytes"] = static_cast<double>(Stats.ResultBytes);
+}
+
+static void BM_BuildFunctionsParallel(benchmark::State& State) {
+  auto& S = syntheticIR(State);
+  for (auto _ : State) {
+    auto Fns = build_functions(S.Ctx, *S.Mod, 0u);
+    benchmark::DoNotOptimize(Fns.data());
+  }
+  setCounters(State);
+}
+
+static void BM_IterateRanges(benchmark::State& State) {
+  auto& S = syntheticIR(State);
+  auto Fns = build_functions(S.Ctx, *S.Mod);
+  for (auto _ : State) {
+    size_t Count = 0;
+    for (auto& Fn : Fns) {
+      for (auto* Block : Fn.entry_blocks()) {
+        benchmark::DoNotOptimize(Block);
+        ++Count;
+      }
+      for (auto* Block : Fn.all_blocks()) {
+        benchmark::DoNotOptimize(Block);
+        ++Count;
+      }
+      for (auto* Sym : Fn.name_symbols()) {
+        benchmark::DoNotOptimize(Sym);
+        ++Count;
+      }
+    }
+    benchmark::DoNotOptimize(Count);
+  }
+  setCounters(State);
+}
+
+static void BM_ExitBlocksLazy(benchmark::State& State) {
+  auto& S = syntheticIR(State);
+  for (auto _ : State) {
+    State.PauseTiming();
+    auto Fns = build_functions(S.Ctx, *S.Mod);
+    State.ResumeTiming();
+    for (auto& Fn : Fns) {
+      benchmark::DoNotOptimize(Fn.exit_blocks_begin());
+    }
+    State.PauseTiming();
+    Fns.clear();
+    State.ResumeTiming();
+  }
+  setCounters(State);
+}
+
+static void BM_ExitBlocksSweep(benchmark::State& State) {
+  auto& S = syntheticIR(State);
+  for (auto _ : State) {
+    State.PauseTiming();
+    auto Fns = build_functions(S.Ctx, *S.Mod);
+    State.ResumeTiming();
+    classify_exits(Fns);
+    State.PauseTiming();
+    Fns.clear();
+    State.ResumeTiming();
+  }
+  setCounters(State);
+}
+
+static void BM_ConstConversion(benchmark::State& State) {
+  auto& S = syntheticIR(State);
+  auto Fns = build_functions(S.Ctx, *S.Mod);
+  for (auto _ : State) {
+    std::vector<Function<const Module>> ConstFns(Fns.begin(), Fns.end());
+    benchmark::DoNotOptimize(ConstFns.data());
+  }
+  setCounters(State);
+}
+
+static void BM_BlockOverlaps(benchmark::State& State) {
+  auto& S = syntheticIR(State);
+  auto Fns = build_functions(S.Ctx, *S.Mod);
+  BlockMembership<Module> Membership(Fns);
+  for (auto _ : State) {
+    auto Overlaps = Membership.overlaps();
+    benchmark::DoNotOptimize(Overlaps.data());
+  }
+  setCounters(State);
+}
+
+static void BM_SweepByAddress(benchmark::State& State) {
+  auto& S = syntheticIR(State);
+  auto Fns = build_functions(S.Ctx, *S.Mod);
+  for (auto _ : State) {
+    uint64_t Bytes = 0;
+    for (auto& Fn : Fns) {
+      for (const auto& Entry : Fn.blocks_by_address()) {
+        Bytes += Entry.Size;
+      }
+    }
+    benchmark::DoNotOptimize(Bytes);
+  }
+  setCounters(State);
+}
+
+// 1k to 1M functions of 8 blocks, 5% of them shared with the next
+// function, and one extra edge per block
+#define FUNCTION_COUNTS                                                        \
+  ArgNames({"functions", "blocks", "shared%", "edges%"})                       \
+      ->ArgsProduct(                                                           \
+          {benchmark::CreateRange(1 << 10, 1 << 20, 8), {8}, {5}, {100}})
+
+// 32k functions with small and large functions, no or heavy sharing, and
+// sparse or dense CFGs
+#define MODULE_SHAPES                                                          \
+  ArgNames({"functions", "blocks", "shared%", "edges%"})                       \
+      ->ArgsProduct({{1 << 15}, {2, 32}, {0, 25}, {25, 400}})
+
+BENCHMARK(BM_BuildFunctions)->FUNCTION_COUNTS->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BuildFunctions)->MODULE_SHAPES->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ResolveDirect)->FUNCTION_COUNTS->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ResolveBatched)->FUNCTION_COUNTS->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BuildFunctionTable)
+    ->FUNCTION_COUNTS->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BuildFunctionsWithExits)
+    ->FUNCTION_COUNTS->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BuildFunctionsWithExits)
+    ->MODULE_SHAPES->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BuildFunctionsParallel)
+    ->FUNCTION_COUNTS->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_IterateRanges)->FUNCTION_COUNTS->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ExitBlocksLazy)->FUNCTION_COUNTS->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ExitBlocksSweep)->FUNCTION_COUNTS->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ExitBlocksSweep)->MODULE_SHAPES->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ConstConversion)->FUNCTION_COUNTS->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BlockOverlaps)->FUNCTION_COUNTS->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BlockOverlaps)->MODULE_SHAPES->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SweepByAddress)->FUNCTION_COUNTS->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv) {
+  Module::registerAuxDataType<schema::FunctionEntries>();
+  Module::registerAuxDataType<schema::FunctionBlocks>();
+  Module::registerAuxDataType<schema::FunctionNames>();
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -1,5 +1,4 @@
-//===- gtirb_functions.hpp -----------------------------------------------*- C++
-//-*-===//
+//===- gtirb_functions.cpp --------------------------------------*- C++ -*-===//
 //
 //  Copyright (C) 2021 GrammaTech, Inc.
 //
@@ -15,8 +14,464 @@
 //===----------------------------------------------------------------------===//
 
 #include "gtirb_functions/gtirb_functions.hpp"
+#include "gtirb_functions/function_cache.hpp"
 #include <gtirb/Casting.hpp>
 #include <gtirb/IR.hpp>
 #include <gtirb/Symbol.hpp>
 
-namespace gtirb {} // namespace gtirb
+// The construction code of Function, compiled once here for both module
+// types. The header declares the instantiations extern, so other
+// translation units call these copies instead of instantiating their own.
+
+namespace gtirb {
+
+template <class ModuleType>
+typename Function<ModuleType>::ExitBlockInfo
+Function<ModuleType>::findExitBlocks(const Module& M,
+                                     const CodeBlockStore& Blocks) {
+  /*
+   * Exit blocks are blocks whose outgoing edges are
+   * returns or sysrets;
+   * edges whose target is not in the function, and which are neither
+   * direct calls or syscalls
+   */
+  std::vector<TaggedExitBlock<const CodeBlock>> ExitBlocks;
+  auto* Ir = M.getIR();
+  if (!Ir) {
+    return ExitBlockInfo();
+  }
+  auto& Cfg = Ir->getCFG();
+  for (auto& Block : Blocks) {
+    for (auto Succ_pair : cfgSuccessors(Cfg, Block)) {
+      auto [Succ, Edge_label] = Succ_pair;
+      if (Edge_label) {
+        auto Dest = dyn_cast<CodeBlock>(Succ);
+        bool InFunction = Dest && Blocks.find(Dest) != Blocks.end();
+        if (uint8_t Kind =
+                detail::classifyExitEdge(*Edge_label, Succ, InFunction)) {
+          ExitBlocks.push_back({Block, Kind});
+        }
+      }
+    }
+  }
+  return makeExitBlockInfo(std::move(ExitBlocks));
+}
+
+template <class ModuleType>
+std::vector<Function<ModuleType>>
+Function<ModuleType>::build_functions(ContextType& C, ModuleType& Mod,
+                                      const FunctionBuildOptions& Opts) {
+  detail::ScopedPhaseTimer Total(Opts.Stats, &FunctionBuildStats::TotalTime);
+  unsigned NumThreads = Opts.NumThreads;
+  if (NumThreads == 0) {
+    NumThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  auto* EntriesByFn = Mod.template getAuxData<schema::FunctionEntries>();
+
+  auto* BlocksByFn = Mod.template getAuxData<schema::FunctionBlocks>();
+
+  auto* FnNames = Mod.template getAuxData<schema::FunctionNames>();
+
+  std::vector<Function<ModuleType>> Fns;
+
+  if (!EntriesByFn) {
+    return Fns;
+  }
+
+  std::optional<UUIDResolver> LocalResolver;
+  const UUIDResolver* Resolver = Opts.Resolver;
+  if (!Resolver || !Resolver->covers(Mod)) {
+    detail::ScopedPhaseTimer Timer(Opts.Stats,
+                                   &FunctionBuildStats::ResolveTime);
+    Resolver = &LocalResolver.emplace(C, Mod);
+  }
+  std::optional<SymbolIndex<const Module>> Symbols;
+  {
+    detail::ScopedPhaseTimer Timer(Opts.Stats,
+                                   &FunctionBuildStats::SymbolTime);
+    Symbols.emplace(Mod);
+  }
+  const detail::IndexedLookup Lookup{*Resolver, *Symbols};
+
+  if (Opts.Stats) {
+    detail::FunctionPhaseTimes Times;
+    Fns = build_all(Lookup, Mod, *EntriesByFn, BlocksByFn, FnNames,
+                    Opts.ExitBlocks, NumThreads,
+                    [&Times]() { return detail::FunctionPhaseTimer(Times); });
+    Opts.Stats->BlockTime +=
+        FunctionBuildStats::duration(Times.Blocks.load());
+    Opts.Stats->NamingTime +=
+        FunctionBuildStats::duration(Times.Naming.load());
+  } else {
+    Fns = build_all(Lookup, Mod, *EntriesByFn, BlocksByFn, FnNames,
+                    Opts.ExitBlocks, NumThreads,
+                    []() { return detail::NullPhaseTimer(); });
+  }
+
+  if (Opts.ExitBlocks == ExitBlockMode::Eager) {
+    classify_exits(Fns, Opts.Stats);
+  }
+
+  if (Opts.Stats) {
+    uint64_t Tables = Symbols->memory_usage();
+    if (LocalResolver) {
+      Tables += LocalResolver->memory_usage();
+    }
+    count_build(*Opts.Stats, Fns, *Resolver, Tables);
+  }
+  return Fns;
+}
+
+template <class ModuleType>
+template <class MakeTimerType>
+std::vector<Function<ModuleType>> Function<ModuleType>::build_all(
+    const detail::IndexedLookup& Lookup, ModuleType& Mod,
+    const EntriesByFnType& EntriesByFn, const BlocksByFnType* BlocksByFn,
+    const FnNamesType* FnNames, ExitBlockMode Exits, unsigned NumThreads,
+    const MakeTimerType& MakeTimer) {
+  if (NumThreads > 1 && EntriesByFn.size() > ParallelChunkSize) {
+    return build_functions_parallel(Lookup, Mod, EntriesByFn, BlocksByFn,
+                                    FnNames, Exits, NumThreads, MakeTimer);
+  }
+  std::vector<Function<ModuleType>> Fns;
+  Fns.reserve(EntriesByFn.size());
+  size_t FnIndex = 0;
+  for (const auto& [FnId, FnEntryIds] : EntriesByFn) {
+    Fns.push_back(build_function(Lookup, Mod, FnIndex++, FnId, FnEntryIds,
+                                 BlocksByFn, FnNames, Exits, MakeTimer()));
+  }
+  return Fns;
+}
+
+template <class ModuleType>
+template <class MakeTimerType>
+std::vector<Function<ModuleType>>
+Function<ModuleType>::build_functions_parallel(
+    const detail::IndexedLookup& Lookup, ModuleType& Mod,
+    const EntriesByFnType& EntriesByFn, const BlocksByFnType* BlocksByFn,
+    const FnNamesType* FnNames, ExitBlockMode Exits, unsigned NumThreads,
+    const MakeTimerType& MakeTimer) {
+  // Fix the output position of every function up front, so that the
+  // result does not depend on scheduling.
+  std::vector<const typename EntriesByFnType::value_type*> Work;
+  Work.reserve(EntriesByFn.size());
+  for (const auto& FnEntry : EntriesByFn) {
+    Work.push_back(&FnEntry);
+  }
+  std::vector<std::optional<Function<ModuleType>>> Slots(Work.size());
+
+  detail::parallel_for(
+      Work.size(), ParallelChunkSize, NumThreads, [&](size_t I) {
+        auto& [FnId, FnEntryIds] = *Work[I];
+        Slots[I].emplace(build_function(Lookup, Mod, I, FnId, FnEntryIds,
+                                        BlocksByFn, FnNames, Exits,
+                                        MakeTimer()));
+      });
+
+  std::vector<Function<ModuleType>> Fns;
+  Fns.reserve(Slots.size());
+  for (auto& Slot : Slots) {
+    Fns.push_back(std::move(*Slot));
+  }
+  return Fns;
+}
+
+template <class ModuleType>
+void Function<ModuleType>::count_build(
+    FunctionBuildStats& Stats, const std::vector<Function<ModuleType>>& Fns,
+    const UUIDResolver& Resolver, uint64_t Tables) {
+  uint64_t Bytes = detail::vectorBytes(Fns);
+  for (const auto& Fn : Fns) {
+    const detail::FunctionData& D = *Fn.Data;
+    Stats.ResolvedReferences +=
+        D.EntryBlocks.size() + D.AllBlocks.size() + (D.CanonName ? 1 : 0);
+    Stats.FunctionsWithoutBlocks += D.AllBlocks.empty();
+    Stats.FunctionsWithoutNames += !D.CanonName && D.NameSymbols.empty();
+    Bytes += sizeof(D) + detail::unorderedBytes(D.EntryBlocks) +
+             detail::unorderedBytes(D.AllBlocks) +
+             detail::unorderedBytes(D.NameSymbols);
+  }
+  Stats.Functions += Fns.size();
+  Stats.DanglingReferences += Resolver.dangling().size();
+  Stats.ResultBytes += Bytes;
+  Stats.PeakBytes += Bytes + Tables;
+}
+
+template <class ModuleType>
+void Function<ModuleType>::classify_exits(
+    std::vector<Function<ModuleType>>& Fns, FunctionBuildStats* Stats) {
+  detail::ScopedPhaseTimer Timer(Stats, &FunctionBuildStats::ExitTime);
+  // Map every block to the functions containing it, as a run of function
+  // indices in Owners.
+  std::vector<std::pair<const CodeBlock*, uint32_t>> Memberships;
+  std::vector<const IR*> Irs;
+  for (size_t I = 0; I < Fns.size(); ++I) {
+    const detail::FunctionData& D = *Fns[I].Data;
+    if (D.SkipExitBlocks || D.Exits.ready()) {
+      continue;
+    }
+    for (const CodeBlock* Block : D.AllBlocks) {
+      Memberships.emplace_back(Block, static_cast<uint32_t>(I));
+    }
+    if (const IR* Ir = D.Mod->getIR()) {
+      if (std::find(Irs.begin(), Irs.end(), Ir) == Irs.end()) {
+        Irs.push_back(Ir);
+      }
+    }
+  }
+  std::sort(Memberships.begin(), Memberships.end());
+
+  std::vector<uint32_t> Owners;
+  Owners.reserve(Memberships.size());
+  std::unordered_map<const CfgNode*, std::pair<uint32_t, uint32_t>>
+      OwnersByBlock;
+  for (const auto& [Block, Fn] : Memberships) {
+    auto [It, Inserted] = OwnersByBlock.try_emplace(
+        Block, static_cast<uint32_t>(Owners.size()), 0);
+    (void)Inserted;
+    Owners.push_back(Fn);
+    ++It->second.second;
+  }
+  auto ownersOf = [&](const CfgNode* Node) {
+    auto It = OwnersByBlock.find(Node);
+    if (It == OwnersByBlock.end()) {
+      return ::boost::iterator_range<const uint32_t*>();
+    }
+    const uint32_t* First = Owners.data() + It->second.first;
+    return ::boost::iterator_range<const uint32_t*>(
+        First, First + It->second.second);
+  };
+
+  std::vector<std::vector<TaggedExitBlock<const CodeBlock>>> Tagged(
+      Fns.size());
+  for (const IR* Ir : Irs) {
+    const CFG& Cfg = Ir->getCFG();
+    for (auto Edge : ::boost::make_iterator_range(::boost::edges(Cfg))) {
+      const EdgeLabel& Label = Cfg[Edge];
+      if (!Label) {
+        continue;
+      }
+      const CfgNode* Source = Cfg[::boost::source(Edge, Cfg)];
+      auto SourceOwners = ownersOf(Source);
+      if (SourceOwners.empty()) {
+        continue;
+      }
+      const CfgNode* Target = Cfg[::boost::target(Edge, Cfg)];
+      auto TargetOwners = ownersOf(Target);
+      for (uint32_t Fn : SourceOwners) {
+        bool InFunction = std::binary_search(TargetOwners.begin(),
+                                             TargetOwners.end(), Fn);
+        if (uint8_t Kind =
+                detail::classifyExitEdge(*Label, Target, InFunction)) {
+          Tagged[Fn].push_back({cast<CodeBlock>(Source), Kind});
+        }
+      }
+    }
+  }
+
+  uint64_t Bytes = 0;
+  for (size_t I = 0; I < Fns.size(); ++I) {
+    const detail::FunctionData& D = *Fns[I].Data;
+    if (!D.SkipExitBlocks && !D.Exits.ready()) {
+      D.Exits.set(makeExitBlockInfo(std::move(Tagged[I])));
+      if (Stats) {
+        const ExitBlockInfo& Exits = Fns[I].getExitBlocks();
+        Bytes += detail::unorderedBytes(Exits.Blocks) +
+                 detail::vectorBytes(Exits.Tagged);
+      }
+    }
+  }
+  if (Stats) {
+    Stats->ResultBytes += Bytes;
+    Stats->PeakBytes += Bytes;
+  }
+}
+
+template class GTIRB_FUNCTIONS_EXPORT_INSTANTIATION Function<Module>;
+template class GTIRB_FUNCTIONS_EXPORT_INSTANTIATION Function<const Module>;
+
+std::vector<Function<Module>> build_functions(Context& C, Module& M) {
+  return Function<Module>::build_functions(C, M, FunctionBuildOptions());
+}
+
+std::vector<Function<const Module>> build_functions(const Context& C,
+                                                    const Module& M) {
+  return Function<const Module>::build_functions(C, M, FunctionBuildOptions());
+}
+
+std::vector<Function<Module>>
+build_functions(Context& C, Module& M, const FunctionBuildOptions& Opts) {
+  return Function<Module>::build_functions(C, M, Opts);
+}
+
+std::vector<Function<const Module>>
+build_functions(const Context& C, const Module& M,
+                const FunctionBuildOptions& Opts) {
+  return Function<const Module>::build_functions(C, M, Opts);
+}
+
+std::vector<Function<Module>> build_functions(Context& C, Module& M,
+                                              unsigned NumThreads) {
+  FunctionBuildOptions Opts;
+  Opts.NumThreads = NumThreads;
+  return build_functions(C, M, Opts);
+}
+
+std::vector<Function<const Module>>
+build_functions(const Context& C, const Module& M, unsigned NumThreads) {
+  FunctionBuildOptions Opts;
+  Opts.NumThreads = NumThreads;
+  return build_functions(C, M, Opts);
+}
+
+template <class ModuleType>
+template <class IRType>
+std::vector<ModuleFunctions<ModuleType>>
+Function<ModuleType>::build_ir_functions(ContextType& C, IRType& Ir,
+                                         const FunctionBuildOptions& Opts) {
+  detail::ScopedPhaseTimer Total(Opts.Stats, &FunctionBuildStats::TotalTime);
+  std::vector<ModuleFunctions<ModuleType>> Result;
+  for (ModuleType& M : Ir.modules()) {
+    Result.push_back({&M, {}});
+  }
+
+  unsigned NumThreads = Opts.NumThreads;
+  if (NumThreads == 0) {
+    NumThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // The tables of one module, and the stats of building it
+  struct ModuleBuild {
+    const EntriesByFnType* EntriesByFn = nullptr;
+    const BlocksByFnType* BlocksByFn = nullptr;
+    const FnNamesType* FnNames = nullptr;
+    std::optional<UUIDResolver> LocalResolver;
+    const UUIDResolver* Resolver = nullptr;
+    std::optional<SymbolIndex<const Module>> Symbols;
+    FunctionBuildStats Stats;
+  };
+  std::vector<ModuleBuild> Builds(Result.size());
+
+  // Index the modules largest first, so that a large executable is not left
+  // to finish alone after its libraries.
+  std::vector<size_t> Order(Result.size());
+  for (size_t I = 0; I < Result.size(); ++I) {
+    Order[I] = I;
+    ModuleBuild& B = Builds[I];
+    ModuleType& Mod = *Result[I].Mod;
+    B.EntriesByFn = Mod.template getAuxData<schema::FunctionEntries>();
+    B.BlocksByFn = Mod.template getAuxData<schema::FunctionBlocks>();
+    B.FnNames = Mod.template getAuxData<schema::FunctionNames>();
+  }
+  auto sizeOf = [&](size_t I) {
+    return Builds[I].EntriesByFn ? Builds[I].EntriesByFn->size() : 0;
+  };
+  std::stable_sort(Order.begin(), Order.end(),
+                   [&](size_t A, size_t B) { return sizeOf(A) > sizeOf(B); });
+  detail::parallel_for(Result.size(), 1, NumThreads, [&](size_t I) {
+    ModuleBuild& B = Builds[Order[I]];
+    const ModuleType& Mod = *Result[Order[I]].Mod;
+    if (!B.EntriesByFn) {
+      return;
+    }
+    FunctionBuildStats* Stats = Opts.Stats ? &B.Stats : nullptr;
+    B.Resolver = Opts.Resolver;
+    if (!B.Resolver || !B.Resolver->covers(Mod)) {
+      detail::ScopedPhaseTimer Timer(Stats, &FunctionBuildStats::ResolveTime);
+      B.Resolver = &B.LocalResolver.emplace(C, Mod);
+    }
+    detail::ScopedPhaseTimer Timer(Stats, &FunctionBuildStats::SymbolTime);
+    B.Symbols.emplace(Mod);
+  });
+
+  // Fix the output position of every function up front, so that the result
+  // does not depend on scheduling.
+  struct Item {
+    size_t Module;
+    size_t FnIndex;
+    const typename EntriesByFnType::value_type* Entry;
+  };
+  std::vector<Item> Work;
+  for (size_t I = 0; I < Result.size(); ++I) {
+    if (!Builds[I].EntriesByFn) {
+      continue;
+    }
+    size_t FnIndex = 0;
+    for (const auto& FnEntry : *Builds[I].EntriesByFn) {
+      Work.push_back({I, FnIndex++, &FnEntry});
+    }
+  }
+  std::vector<std::optional<Function<ModuleType>>> Slots(Work.size());
+
+  auto buildAll = [&](const auto& MakeTimer) {
+    detail::parallel_for(
+        Work.size(), ParallelChunkSize, NumThreads, [&](size_t I) {
+          const Item& W = Work[I];
+          const ModuleBuild& B = Builds[W.Module];
+          const detail::IndexedLookup Lookup{*B.Resolver, *B.Symbols};
+          auto& [FnId, FnEntryIds] = *W.Entry;
+          Slots[I].emplace(build_function(
+              Lookup, *Result[W.Module].Mod, W.FnIndex, FnId, FnEntryIds,
+              B.BlocksByFn, B.FnNames, Opts.ExitBlocks, MakeTimer()));
+        });
+  };
+  detail::FunctionPhaseTimes Times;
+  if (Opts.Stats) {
+    buildAll([&Times]() { return detail::FunctionPhaseTimer(Times); });
+  } else {
+    buildAll([]() { return detail::NullPhaseTimer(); });
+  }
+
+  auto Slot = Slots.begin();
+  for (size_t I = 0; I < Result.size(); ++I) {
+    auto& Fns = Result[I].Functions;
+    Fns.reserve(sizeOf(I));
+    for (size_t N = sizeOf(I); N > 0; --N, ++Slot) {
+      Fns.push_back(std::move(**Slot));
+    }
+  }
+
+  if (Opts.Stats) {
+    FunctionBuildStats Sum;
+    for (size_t I = 0; I < Result.size(); ++I) {
+      ModuleBuild& B = Builds[I];
+      if (!B.EntriesByFn) {
+        continue;
+      }
+      uint64_t Tables = B.Symbols->memory_usage();
+      if (B.LocalResolver) {
+        Tables += B.LocalResolver->memory_usage();
+      }
+      count_build(B.Stats, Result[I].Functions, *B.Resolver, Tables);
+      Sum += B.Stats;
+    }
+    Sum.BlockTime += FunctionBuildStats::duration(Times.Blocks.load());
+    Sum.NamingTime += FunctionBuildStats::duration(Times.Naming.load());
+    *Opts.Stats += Sum;
+  }
+
+  if (Opts.ExitBlocks == ExitBlockMode::Eager) {
+    // Copies share their data, so classifying them fills in the results.
+    // Exits of all modules are classified in one pass over the shared CFG.
+    std::vector<Function<ModuleType>> All;
+    for (auto& R : Result) {
+      All.insert(All.end(), R.Functions.begin(), R.Functions.end());
+    }
+    classify_exits(All, Opts.Stats);
+  }
+  return Result;
+}
+
+std::vector<ModuleFunctions<Module>>
+build_functions(Context& C, IR& Ir, const FunctionBuildOptions& Opts) {
+  return Function<Module>::build_ir_functions(C, Ir, Opts);
+}
+
+std::vector<ModuleFunctions<const Module>>
+build_functions(const Context& C, const IR& Ir,
+                const FunctionBuildOptions& Opts) {
+  return Function<const Module>::build_ir_functions(C, Ir, Opts);
+}
+
+} // namespace gtirb
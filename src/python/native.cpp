@@ -0,0 +1,328 @@
+//===- native.cpp -----------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// The gtirb_functions._native extension module: builds the functions of a
+// GTIRB file with build_functions() and hands them to Python as compact,
+// index-based records. See gtirb_functions/records.py, which wraps it and
+// falls back to pure Python when it is not installed.
+//
+//===----------------------------------------------------------------------===//
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "gtirb_functions/block_membership.hpp"
+#include "gtirb_functions/gtirb_functions.hpp"
+#include <gtirb/gtirb.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace gtirb;
+
+namespace {
+
+/// \brief A function, as handed to Python
+struct FunctionRecord {
+  UUID Uuid;
+  std::optional<std::string> Name;
+  std::vector<std::string> Names;
+  std::vector<uint32_t> EntryBlocks;
+  std::vector<uint32_t> ExitBlocks;
+  std::vector<uint32_t> AllBlocks;
+};
+
+/// \brief The functions of a module, as handed to Python
+struct ModuleRecord {
+  std::string Name;
+  std::vector<UUID> BlockUuids;
+  std::vector<std::optional<uint64_t>> BlockAddresses;
+  std::vector<uint64_t> BlockSizes;
+  std::vector<FunctionRecord> Functions;
+};
+
+/// \brief Number the blocks of \p Fns and describe them by index
+ModuleRecord makeRecord(const Module& M,
+                        const std::vector<Function<const Module>>& Fns,
+                        bool ComputeExits) {
+  ModuleRecord R;
+  R.Name = M.getName();
+
+  BlockNumbering Numbering(Fns);
+  R.BlockUuids.reserve(Numbering.size());
+  R.BlockAddresses.reserve(Numbering.size());
+  R.BlockSizes.reserve(Numbering.size());
+  for (uint32_t I = 0; I < Numbering.size(); ++I) {
+    const CodeBlock* Block = Numbering.block(I);
+    R.BlockUuids.push_back(Block->getUUID());
+    if (auto A = Block->getAddress()) {
+      R.BlockAddresses.push_back(static_cast<uint64_t>(*A));
+    } else {
+      R.BlockAddresses.push_back(std::nullopt);
+    }
+    R.BlockSizes.push_back(Block->getSize());
+  }
+
+  R.Functions.reserve(Fns.size());
+  for (const auto& Fn : Fns) {
+    FunctionRecord F;
+    F.Uuid = Fn.getUUID();
+    if (const Symbol* Name = Fn.getName()) {
+      F.Name = Name->getName();
+      F.Names.push_back(Name->getName());
+    }
+    for (const Symbol* Sym : Fn.name_symbols()) {
+      F.Names.push_back(Sym->getName());
+    }
+    std::sort(F.Names.begin(), F.Names.end());
+    F.Names.erase(std::unique(F.Names.begin(), F.Names.end()), F.Names.end());
+
+    auto indices = [&Numbering](const auto& Blocks) {
+      std::vector<uint32_t> Indices = Numbering.indices(Blocks);
+      std::sort(Indices.begin(), Indices.end());
+      return Indices;
+    };
+    F.EntryBlocks = indices(Fn.entry_blocks());
+    F.AllBlocks = indices(Fn.all_blocks());
+    if (ComputeExits) {
+      F.ExitBlocks = indices(Fn.exit_blocks());
+    }
+    R.Functions.push_back(std::move(F));
+  }
+  return R;
+}
+
+/// \brief Load the IR at \p Path and describe the functions of its modules
+///
+/// Runs without the GIL, so it must not touch Python objects.
+///
+/// \return nothing, with \p Error set, on failure
+std::optional<std::vector<ModuleRecord>>
+buildRecords(const char* Path, bool ComputeExits, unsigned NumThreads,
+             PyObject*& ErrorType, std::string& Error) {
+  std::ifstream In(Path, std::ios::in | std::ios::binary);
+  if (!In) {
+    ErrorType = PyExc_OSError;
+    Error = std::string("cannot open ") + Path;
+    return std::nullopt;
+  }
+  Context C;
+  auto Ir = IR::load(C, In);
+  if (!Ir) {
+    ErrorType = PyExc_ValueError;
+    Error = std::string("could not load the IR in ") + Path;
+    return std::nullopt;
+  }
+
+  FunctionBuildOptions Opts;
+  Opts.NumThreads = NumThreads;
+  Opts.ExitBlocks = ComputeExits ? ExitBlockMode::Eager : ExitBlockMode::Skip;
+  const IR& ConstIr = **Ir;
+  std::vector<ModuleRecord> Records;
+  for (auto& [Mod, Fns] : build_functions(C, ConstIr, Opts)) {
+    Records.push_back(makeRecord(*Mod, Fns, ComputeExits));
+  }
+  return Records;
+}
+
+/// \brief Return a new tuple of ints holding \p Indices, or null
+PyObject* indexTuple(const std::vector<uint32_t>& Indices) {
+  PyObject* Tuple = PyTuple_New(static_cast<Py_ssize_t>(Indices.size()));
+  if (!Tuple) {
+    return nullptr;
+  }
+  for (size_t I = 0; I < Indices.size(); ++I) {
+    PyObject* Index = PyLong_FromUnsignedLong(Indices[I]);
+    if (!Index) {
+      Py_DECREF(Tuple);
+      return nullptr;
+    }
+    PyTuple_SET_ITEM(Tuple, static_cast<Py_ssize_t>(I), Index);
+  }
+  return Tuple;
+}
+
+/// \brief Return a new str holding \p S, or null
+PyObject* string(const std::string& S) {
+  return PyUnicode_DecodeUTF8(S.data(), static_cast<Py_ssize_t>(S.size()),
+                              "surrogateescape");
+}
+
+/// \brief Return \p Uuid as a new 16-byte bytes object, or null
+PyObject* uuidBytes(const UUID& Uuid) {
+  return PyBytes_FromStringAndSize(reinterpret_cast<const char*>(Uuid.data),
+                                   static_cast<Py_ssize_t>(Uuid.size()));
+}
+
+/// \brief Return \p F as a new (uuid, name, names, entries, exits, blocks)
+/// tuple, or null
+PyObject* toPython(const FunctionRecord& F) {
+  PyObject* Names = PyTuple_New(static_cast<Py_ssize_t>(F.Names.size()));
+  if (!Names) {
+    return nullptr;
+  }
+  for (size_t I = 0; I < F.Names.size(); ++I) {
+    PyObject* Name = string(F.Names[I]);
+    if (!Name) {
+      Py_DECREF(Names);
+      return nullptr;
+    }
+    PyTuple_SET_ITEM(Names, static_cast<Py_ssize_t>(I), Name);
+  }
+  PyObject* Name = nullptr;
+  if (F.Name) {
+    Name = string(*F.Name);
+  } else {
+    Name = Py_None;
+    Py_INCREF(Name);
+  }
+  // "N" steals the references, including on failure.
+  return Py_BuildValue("(NNNNNN)", uuidBytes(F.Uuid), Name, Names,
+                       indexTuple(F.EntryBlocks), indexTuple(F.ExitBlocks),
+                       indexTuple(F.AllBlocks));
+}
+
+/// \brief Return \p R as a new (name, block_uuids, block_addresses,
+/// block_sizes, functions) tuple, or null
+///
+/// Block UUIDs are packed into one bytes object, 16 bytes per block.
+PyObject* toPython(const ModuleRecord& R) {
+  std::string Packed;
+  Packed.reserve(R.BlockUuids.size() * 16);
+  for (const UUID& Uuid : R.BlockUuids) {
+    Packed.append(reinterpret_cast<const char*>(Uuid.data), Uuid.size());
+  }
+  PyObject* Uuids = PyBytes_FromStringAndSize(
+      Packed.data(), static_cast<Py_ssize_t>(Packed.size()));
+
+  PyObject* Addresses =
+      PyList_New(static_cast<Py_ssize_t>(R.BlockAddresses.size()));
+  for (size_t I = 0; Addresses && I < R.BlockAddresses.size(); ++I) {
+    PyObject* Address = nullptr;
+    if (R.BlockAddresses[I]) {
+      Address = PyLong_FromUnsignedLongLong(*R.BlockAddresses[I]);
+    } else {
+      Address = Py_None;
+      Py_INCREF(Address);
+    }
+    if (!Address) {
+      Py_CLEAR(Addresses);
+      break;
+    }
+    PyList_SET_ITEM(Addresses, static_cast<Py_ssize_t>(I), Address);
+  }
+
+  PyObject* Sizes = PyList_New(static_cast<Py_ssize_t>(R.BlockSizes.size()));
+  for (size_t I = 0; Sizes && I < R.BlockSizes.size(); ++I) {
+    PyObject* Size = PyLong_FromUnsignedLongLong(R.BlockSizes[I]);
+    if (!Size) {
+      Py_CLEAR(Sizes);
+      break;
+    }
+    PyList_SET_ITEM(Sizes, static_cast<Py_ssize_t>(I), Size);
+  }
+
+  PyObject* Functions =
+      PyList_New(static_cast<Py_ssize_t>(R.Functions.size()));
+  for (size_t I = 0; Functions && I < R.Functions.size(); ++I) {
+    PyObject* F = toPython(R.Functions[I]);
+    if (!F) {
+      Py_CLEAR(Functions);
+      break;
+    }
+    PyList_SET_ITEM(Functions, static_cast<Py_ssize_t>(I), F);
+  }
+
+  return Py_BuildValue("(NNNNN)", string(R.Name), Uuids, Addresses, Sizes,
+                       Functions);
+}
+
+PyObject* buildFunctions(PyObject*, PyObject* Args, PyObject* Kwargs) {
+  static const char* Keywords[] = {"path", "compute_exits", "num_threads",
+                                   nullptr};
+  PyObject* PathObj = nullptr;
+  int ComputeExits = 1;
+  unsigned NumThreads = 1;
+  if (!PyArg_ParseTupleAndKeywords(Args, Kwargs, "O&|pI",
+                                   const_cast<char**>(Keywords),
+                                   PyUnicode_FSConverter, &PathObj,
+                                   &ComputeExits, &NumThreads)) {
+    return nullptr;
+  }
+
+  std::optional<std::vector<ModuleRecord>> Records;
+  PyObject* ErrorType = PyExc_RuntimeError;
+  std::string Error;
+  Py_BEGIN_ALLOW_THREADS;
+  try {
+    Records = buildRecords(PyBytes_AS_STRING(PathObj), ComputeExits != 0,
+                           NumThreads, ErrorType, Error);
+  } catch (const std::exception& E) {
+    Error = E.what();
+  } catch (...) {
+    Error = "unknown error";
+  }
+  Py_END_ALLOW_THREADS;
+  Py_DECREF(PathObj);
+
+  if (!Records) {
+    PyErr_SetString(ErrorType, Error.c_str());
+    return nullptr;
+  }
+
+  PyObject* Result = PyList_New(static_cast<Py_ssize_t>(Records->size()));
+  for (size_t I = 0; Result && I < Records->size(); ++I) {
+    PyObject* M = toPython((*Records)[I]);
+    if (!M) {
+      Py_CLEAR(Result);
+      break;
+    }
+    PyList_SET_ITEM(Result, static_cast<Py_ssize_t>(I), M);
+  }
+  return Result;
+}
+
+PyMethodDef Methods[] = {
+    // Through void (*)(), as METH_KEYWORDS functions take a third argument
+    {"build_functions",
+     reinterpret_cast<PyCFunction>(
+         reinterpret_cast<void (*)()>(buildFunctions)),
+     METH_VARARGS | METH_KEYWORDS,
+     "build_functions(path, compute_exits=True, num_threads=1)\n"
+     "--\n\n"
+     "Load the GTIRB file at path and build the functions of each of its\n"
+     "modules. Returns a list with one (name, block_uuids, block_addresses,\n"
+     "block_sizes, functions) tuple per module.\n"
+     "block_uuids packs 16 bytes per block. Each function is a\n"
+     "(uuid, name, names, entries, exits, blocks) tuple, with blocks given\n"
+     "by their index in the module's block table."},
+    {nullptr, nullptr, 0, nullptr}};
+
+PyModuleDef ModuleDef = {PyModuleDef_HEAD_INIT,
+                         "gtirb_functions._native",
+                         "Functions of GTIRB files, built in C++.",
+                         -1,
+                         Methods,
+                         nullptr,
+                         nullptr,
+                         nullptr,
+                         nullptr};
+
+} // namespace
+
+PyMODINIT_FUNC PyInit__native() { return PyModule_Create(&ModuleDef); }
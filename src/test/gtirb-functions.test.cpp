@@ -1,10 +1,22 @@
+#include "gtirb_functions/block_membership.hpp"
+#include "gtirb_functions/call_graph.hpp"
+#include "gtirb_functions/function_cache.hpp"
+#include "gtirb_functions/function_edits.hpp"
+#include "gtirb_functions/function_index.hpp"
+#include "gtirb_functions/function_set.hpp"
+#include "gtirb_functions/function_stream.hpp"
+#include "gtirb_functions/function_table.hpp"
 #include "gtirb_functions/gtirb_functions.hpp"
+#include "gtirb_functions/name_pool.hpp"
+#include "gtirb_functions/symbol_index.hpp"
+#include "gtirb_functions/uuid_resolver.hpp"
 #include <gtirb/gtirb.hpp>
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/properties.hpp>
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 #include <gtest/gtest.h>
+#include <sstream>
 
 using namespace gtirb;
 using NodeMap = std::map<int, CfgNode*>;
@@ -73,7 +85,8 @@ protected:
     return id;
   }
 
-  void addEdge(int src, int dst, EdgeType edge_type, ConditionalEdge cond) {
+  void addEdge(int src, int dst, EdgeType edge_type, ConditionalEdge cond,
+               DirectEdge direct = DirectEdge::IsDirect) {
     auto& graph = IR->getCFG();
     auto* b1 = blocks[src];
     auto* b2 = blocks[dst];
@@ -90,10 +103,19 @@ protected:
     auto const opt_edgedesc = gtirb::addEdge(b1, b2, graph);
     ASSERT_TRUE(opt_edgedesc);
 
-    EdgeLabel prop{std::tuple{cond, DirectEdge::IsDirect, edge_type}};
+    EdgeLabel prop{std::tuple{cond, direct, edge_type}};
     graph[*opt_edgedesc] = prop;
   }
 
+  void writeAuxData() {
+    auto tmp_blocks = fn_blocks;
+    M->addAuxData<schema::FunctionBlocks>(std::move(tmp_blocks));
+    auto tmp_entries = fn_entries;
+    M->addAuxData<schema::FunctionEntries>(std::move(tmp_entries));
+    auto tmp_names = fn_names;
+    M->addAuxData<schema::FunctionNames>(std::move(tmp_names));
+  }
+
   void addFallthrough(int src, int dst) {
     addEdge(src, dst, EdgeType::Fallthrough, ConditionalEdge::OnFalse);
   }
@@ -102,6 +124,11 @@ protected:
     addEdge(src, dst, EdgeType::Branch, ConditionalEdge::OnTrue);
   }
 
+  void addIndirectBranch(int src, int dst) {
+    addEdge(src, dst, EdgeType::Branch, ConditionalEdge::OnFalse,
+            DirectEdge::IsIndirect);
+  }
+
   void addReturn(int src, int dst) {
     addEdge(src, dst, EdgeType::Return, ConditionalEdge::OnFalse);
   }
@@ -132,13 +159,7 @@ protected:
     auto sym = Symbol::Create(C, get_code_block(blocks, 7), "f4");
     M->addSymbol(sym);
 
-    // write out aux data
-    auto tmp_blocks = fn_blocks;
-    M->addAuxData<schema::FunctionBlocks>(std::move(tmp_blocks));
-    auto tmp_entries = fn_entries;
-    M->addAuxData<schema::FunctionEntries>(std::move(tmp_entries));
-    auto tmp_names = fn_names;
-    M->addAuxData<schema::FunctionNames>(std::move(tmp_names));
+    writeAuxData();
 
     functions = build_functions(C, *M);
   };
@@ -147,17 +168,26 @@ protected:
 /// TESTS
 
 TEST_F(TestData, TEST_CONST) {
-  static_assert(std::is_same<Function<Module>::code_block_iterator,
-                             Function<Module>::CodeBlockSet::iterator>::value);
+  using MutableIter = Function<Module>::code_block_iterator;
+  using ConstIter = Function<const Module>::code_block_iterator;
+  static_assert(std::is_same<std::iterator_traits<MutableIter>::reference,
+                             CodeBlock* const&>::value);
+  static_assert(std::is_same<std::iterator_traits<ConstIter>::reference,
+                             const CodeBlock* const&>::value);
 
-  static_assert(std::is_same<
-                Function<const Module>::code_block_iterator,
-                Function<const Module>::CodeBlockSet::const_iterator>::value);
+  static_assert(
+      std::is_convertible<Function<Module>, Function<const Module>>::value);
+  static_assert(
+      !std::is_convertible<Function<const Module>, Function<Module>>::value);
 
   Function<const Module> f = functions[0];
   // This fails at compile time, since you cannot convert e.g. a const CodeBlock
   // * to a CodeBlock *
   // Function<Module> f2 = f;
+
+  // The conversion shares the underlying data rather than copying it
+  EXPECT_EQ(&*f.all_blocks_begin(), &*functions[0].all_blocks_begin());
+  EXPECT_EQ(&f.getLongName(), &functions[0].getLongName());
   const Module& M2 = *M;
   auto funs2 = build_functions(C, M2);
   static_assert(std::is_same<decltype(funs2),
@@ -183,8 +213,46 @@ TEST_F(TestData, TEST_LONG_NAMES) {
       EXPECT_EQ(fun.getLongName(), "f1");
     } else if (fun.getUUID() == f3) {
       EXPECT_EQ(fun.getLongName(), "f3 (a.k.a f4)");
+      // Formatted once, then cached
+      EXPECT_EQ(&fun.getLongName(), &fun.getLongName());
+    }
+    EXPECT_EQ(fun.getLongNameView(), fun.getLongName());
+    EXPECT_EQ(fun.getNameView(), fun.getName()->getName());
+  }
+}
+
+TEST_F(TestData, TEST_NAME_POOL) {
+  // A second function named f1, and one without a name
+  auto f5 = make_function("f1", {10}, {10});
+  auto f6 = make_function("f6", {3}, {3});
+  fn_names.erase(f6);
+  writeAuxData();
+
+  auto fns = build_functions(C, *M);
+  ASSERT_EQ(fns.size(), 5);
+  NamePool pool(fns);
+  EXPECT_EQ(pool.size(), 3);
+  for (size_t i = 0; i < fns.size(); ++i) {
+    auto id = pool.name_id(i);
+    if (fns[i].getUUID() == f6) {
+      EXPECT_EQ(id, NamePool::NoName);
+      EXPECT_EQ(fns[i].getNameView(), "");
+      continue;
     }
+    EXPECT_EQ(pool.name(id), fns[i].getNameView());
+    EXPECT_EQ(pool.find(fns[i].getNameView()), id);
+    auto owners = pool.functions(id);
+    EXPECT_NE(std::find(owners.begin(), owners.end(), i), owners.end());
   }
+
+  auto f1_id = pool.find("f1");
+  ASSERT_TRUE(f1_id);
+  std::set<UUID> named_f1;
+  for (size_t i : pool.functions(*f1_id)) {
+    named_f1.insert(fns[i].getUUID());
+  }
+  EXPECT_EQ(named_f1, (std::set<UUID>{f1, f5}));
+  EXPECT_FALSE(pool.find("f4"));
 }
 
 TEST_F(TestData, TEST_UUIDS) {
@@ -258,3 +326,941 @@ TEST_F(TestData, TEST_BLOCKS) {
     }
   }
 }
+
+TEST_F(TestData, TEST_PARALLEL) {
+  // Enough functions that the work is actually split across threads
+  for (int i = 0; i < 500; ++i) {
+    make_function("g" + std::to_string(i), {i % 11}, {i % 11, (i + 1) % 11});
+  }
+  writeAuxData();
+
+  auto serial = build_functions(C, *M);
+  ASSERT_EQ(serial.size(), 503);
+  for (unsigned threads : {0u, 1u, 4u}) {
+    auto parallel = build_functions(C, *M, threads);
+    ASSERT_EQ(parallel.size(), serial.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+      auto& s = serial[i];
+      auto& p = parallel[i];
+      EXPECT_EQ(p.getUUID(), s.getUUID());
+      EXPECT_EQ(p.getName(), s.getName());
+      EXPECT_EQ(p.getLongName(), s.getLongName());
+      auto as_set = [](auto range) {
+        return std::set<CodeBlock*>(range.begin(), range.end());
+      };
+      EXPECT_EQ(as_set(p.entry_blocks()), as_set(s.entry_blocks()));
+      EXPECT_EQ(as_set(p.exit_blocks()), as_set(s.exit_blocks()));
+      EXPECT_EQ(as_set(p.all_blocks()), as_set(s.all_blocks()));
+    }
+  }
+
+  const Module& M2 = *M;
+  auto const_parallel = build_functions(C, M2, 4);
+  EXPECT_EQ(const_parallel.size(), serial.size());
+}
+
+TEST_F(TestData, TEST_EXIT_MODES) {
+  auto as_set = [](auto range) {
+    return std::set<CodeBlock*>(range.begin(), range.end());
+  };
+  auto lazy = build_functions(C, *M);
+
+  FunctionBuildOptions opts;
+  opts.ExitBlocks = ExitBlockMode::Eager;
+  auto eager = build_functions(C, *M, opts);
+
+  opts.ExitBlocks = ExitBlockMode::Skip;
+  auto skipped = build_functions(C, *M, opts);
+
+  ASSERT_EQ(lazy.size(), eager.size());
+  ASSERT_EQ(lazy.size(), skipped.size());
+  for (size_t i = 0; i < lazy.size(); ++i) {
+    EXPECT_EQ(as_set(lazy[i].exit_blocks()), as_set(eager[i].exit_blocks()));
+    EXPECT_EQ(skipped[i].exit_blocks_begin(), skipped[i].exit_blocks_end());
+    // Skipping exits does not affect the rest of the function
+    EXPECT_EQ(as_set(skipped[i].all_blocks()), as_set(lazy[i].all_blocks()));
+  }
+}
+
+TEST_F(TestData, TEST_TAGGED_EXITS) {
+  // f2 tail-calls f3, f1 has an unresolved indirect jump, and f3 jumps
+  // directly to a proxy block, as to an import
+  addBranch(5, 6);
+  addIndirectBranch(1, 11);
+  addBranch(8, 11);
+
+  auto kinds_of = [](auto& fun) {
+    std::map<CodeBlock*, uint8_t> kinds;
+    for (auto exit : fun.tagged_exit_blocks()) {
+      EXPECT_EQ(kinds.count(exit.Block), 0);
+      kinds[exit.Block] = exit.Kinds;
+    }
+    return kinds;
+  };
+  auto lazy = build_functions(C, *M);
+  std::vector<Function<Module>> swept = build_functions(C, *M);
+  classify_exits(swept);
+
+  ASSERT_EQ(lazy.size(), 3);
+  ASSERT_EQ(swept.size(), 3);
+  for (size_t i = 0; i < lazy.size(); ++i) {
+    EXPECT_EQ(kinds_of(lazy[i]), kinds_of(swept[i]));
+    std::set<CodeBlock*> exits(swept[i].exit_blocks().begin(),
+                               swept[i].exit_blocks().end());
+    std::set<CodeBlock*> tagged;
+    for (auto exit : swept[i].tagged_exit_blocks()) {
+      tagged.insert(exit.Block);
+    }
+    EXPECT_EQ(exits, tagged);
+  }
+
+  auto kinds = [](std::initializer_list<ExitKind> ks) {
+    uint8_t result = 0;
+    for (auto k : ks) {
+      result |= static_cast<uint8_t>(k);
+    }
+    return result;
+  };
+  auto block = [this](int i) { return get_code_block(blocks, i); };
+  std::map<CodeBlock*, uint8_t> f1{
+      {block(1), kinds({ExitKind::Unresolved})},
+      {block(2), kinds({ExitKind::Return})}};
+  std::map<CodeBlock*, uint8_t> f2{
+      {block(4), kinds({ExitKind::Return})},
+      {block(5), kinds({ExitKind::TailCall})}};
+  // A return to a proxy block is a return, not an unresolved jump, and a
+  // direct jump to one is a tail call
+  std::map<CodeBlock*, uint8_t> f3{
+      {block(8), kinds({ExitKind::Fallthrough, ExitKind::TailCall})},
+      {block(9), kinds({ExitKind::Return})}};
+  for (auto& fun : swept) {
+    auto name = fun.getName()->getName();
+    if (name == "f1") {
+      EXPECT_EQ(kinds_of(fun), f1);
+    } else if (name == "f2") {
+      EXPECT_EQ(kinds_of(fun), f2);
+    } else {
+      EXPECT_EQ(kinds_of(fun), f3);
+    }
+  }
+
+  // The const module sees the same tags
+  std::vector<Function<const Module>> const_fns(swept.begin(), swept.end());
+  for (size_t i = 0; i < swept.size(); ++i) {
+    auto tagged = const_fns[i].tagged_exit_blocks();
+    auto mutable_tagged = swept[i].tagged_exit_blocks();
+    ASSERT_EQ(boost::distance(tagged), boost::distance(mutable_tagged));
+    auto it = mutable_tagged.begin();
+    for (const TaggedExitBlock<const CodeBlock>& exit : tagged) {
+      EXPECT_EQ(exit.Block, it->Block);
+      EXPECT_EQ(exit.Kinds, it->Kinds);
+      ++it;
+    }
+  }
+}
+
+TEST_F(TestData, TEST_UUID_RESOLVER) {
+  UUIDResolver resolver(C, *M);
+  EXPECT_EQ(resolver.module(), M);
+  EXPECT_TRUE(resolver.dangling().empty());
+  EXPECT_TRUE(resolver.covers(*M));
+  // Functions are resolved in FunctionEntries order
+  ASSERT_EQ(resolver.size(), fn_entries.size());
+  size_t pos = 0;
+  for (auto& [fn, entries] : fn_entries) {
+    EXPECT_EQ(resolver.function(pos), fn);
+    std::set<UUID> ids;
+    for (const CodeBlock* block : resolver.entry_blocks(pos)) {
+      ids.insert(block->getUUID());
+    }
+    EXPECT_EQ(ids, entries);
+    ids.clear();
+    for (const CodeBlock* block : resolver.blocks(pos)) {
+      ids.insert(block->getUUID());
+    }
+    EXPECT_EQ(ids, fn_blocks[fn]);
+    ASSERT_NE(resolver.name(pos), nullptr);
+    EXPECT_EQ(resolver.name(pos)->getUUID(), fn_names[fn]);
+    ++pos;
+  }
+
+  // Reference a missing block, a missing entry and a non-symbol name
+  auto missing = boost::uuids::random_generator()();
+  fn_blocks[f2].insert(missing);
+  fn_entries[f3].insert(missing);
+  fn_names[f1] = blocks[0]->getUUID();
+  writeAuxData();
+
+  resolver.rebuild(C, *M);
+  for (size_t i = 0; i < resolver.size(); ++i) {
+    EXPECT_EQ(resolver.name(i) == nullptr, resolver.function(i) == f1);
+  }
+  using Table = UUIDResolver::Table;
+  std::vector<std::tuple<UUID, UUID, Table>> expected{
+      {f3, missing, Table::FunctionEntries},
+      {f2, missing, Table::FunctionBlocks},
+      {f1, blocks[0]->getUUID(), Table::FunctionNames}};
+  std::vector<std::tuple<UUID, UUID, Table>> dangling;
+  for (auto& ref : resolver.dangling()) {
+    dangling.emplace_back(ref.Function, ref.Id, ref.Source);
+  }
+  EXPECT_EQ(dangling, expected);
+
+  // The resolver can be reused across builds
+  FunctionBuildOptions opts;
+  opts.Resolver = &resolver;
+  for (int i = 0; i < 2; ++i) {
+    auto fns = build_functions(C, *M, opts);
+    ASSERT_EQ(fns.size(), 3);
+    for (auto& fun : fns) {
+      EXPECT_EQ(fun.getName() == nullptr, fun.getUUID() == f1);
+      EXPECT_EQ(boost::distance(fun.all_blocks()),
+                fn_blocks[fun.getUUID()].size() - (fun.getUUID() == f2));
+    }
+  }
+}
+
+TEST_F(TestData, TEST_SYMBOL_INDEX) {
+  // A second symbol on an entry block, and one without a referent
+  M->addSymbol(Symbol::Create(C, get_code_block(blocks, 7), "f4_alias"));
+  M->addSymbol(Symbol::Create(C, nullptr, "orphan"));
+
+  SymbolIndex<Module> index(*M);
+  SymbolIndex<const Module> const_index(*M);
+  EXPECT_EQ(index.size(), 4);
+  for (auto& [i, block] : blocks) {
+    (void)i;
+    std::vector<Symbol*> expected;
+    for (auto& sym : M->findSymbols(*block)) {
+      expected.push_back(&sym);
+    }
+    std::vector<Symbol*> found(index.symbols(block).begin(),
+                               index.symbols(block).end());
+    EXPECT_EQ(found, expected);
+    std::vector<const Symbol*> const_found(const_index.symbols(*block).begin(),
+                                           const_index.symbols(*block).end());
+    EXPECT_EQ(const_found,
+              std::vector<const Symbol*>(expected.begin(), expected.end()));
+  }
+
+  auto fns = build_functions(C, *M);
+  for (auto& fun : fns) {
+    if (fun.getName()->getName() == "f3") {
+      std::set<std::string> names;
+      for (auto* sym : fun.name_symbols()) {
+        names.insert(sym->getName());
+      }
+      EXPECT_EQ(names, (std::set<std::string>{"f3", "f4", "f4_alias"}));
+    }
+  }
+}
+
+TEST_F(TestData, TEST_FUNCTION_SET) {
+  auto as_set = [](auto range) {
+    return std::set<CodeBlock*>(range.begin(), range.end());
+  };
+  // Check the set against a build from scratch
+  auto check = [&](FunctionSet<Module>& set) {
+    auto fresh = build_functions(C, *M);
+    auto current = set.snapshot();
+    ASSERT_EQ(current.size(), fresh.size());
+    for (size_t i = 0; i < fresh.size(); ++i) {
+      EXPECT_EQ(current[i].getUUID(), fresh[i].getUUID());
+      EXPECT_EQ(as_set(current[i].entry_blocks()),
+                as_set(fresh[i].entry_blocks()));
+      EXPECT_EQ(as_set(current[i].all_blocks()), as_set(fresh[i].all_blocks()));
+      EXPECT_EQ(as_set(current[i].exit_blocks()),
+                as_set(fresh[i].exit_blocks()));
+      EXPECT_EQ(current[i].getLongName(), fresh[i].getLongName());
+    }
+  };
+
+  FunctionSet<Module> set(C, *M);
+  EXPECT_EQ(set.size(), 3);
+  check(set);
+
+  // Re-block f2
+  fn_blocks[f2].insert(blocks[3]->getUUID());
+  writeAuxData();
+  set.function_changed(f2);
+  check(set);
+  EXPECT_EQ(set.owners(get_code_block(blocks, 3)), std::vector<UUID>{f2});
+
+  // A new edge turns block 5 into a tail call; earlier copies are unaffected
+  auto before = *set.find(f2);
+  EXPECT_EQ(as_set(before.exit_blocks()),
+            std::set<CodeBlock*>{get_code_block(blocks, 4)});
+  addBranch(5, 6);
+  set.edge_changed(*blocks[5]);
+  check(set);
+  EXPECT_EQ(as_set(set.find(f2)->exit_blocks()),
+            (std::set<CodeBlock*>{get_code_block(blocks, 4),
+                                  get_code_block(blocks, 5)}));
+  EXPECT_EQ(as_set(before.exit_blocks()),
+            std::set<CodeBlock*>{get_code_block(blocks, 4)});
+
+  // Add a function
+  auto f5 = make_function("f5", {10}, {10});
+  writeAuxData();
+  set.function_changed(f5);
+  EXPECT_EQ(set.size(), 4);
+  check(set);
+
+  // Remove one
+  fn_entries.erase(f3);
+  fn_blocks.erase(f3);
+  fn_names.erase(f3);
+  writeAuxData();
+  set.function_changed(f3);
+  EXPECT_EQ(set.size(), 3);
+  EXPECT_EQ(set.find(f3), nullptr);
+  EXPECT_TRUE(set.owners(get_code_block(blocks, 8)).empty());
+  check(set);
+}
+
+TEST_F(TestData, TEST_IR_FUNCTIONS) {
+  auto as_set = [](auto range) {
+    return std::set<CodeBlock*>(range.begin(), range.end());
+  };
+  // A second module, with a function made of blocks of its own
+  auto* M2 = Module::Create(C, "library");
+  IR->addModule(M2);
+  auto* S2 = Section::Create(C, ".text");
+  M2->addSection(S2);
+  auto* I2 = ByteInterval::Create(C, std::make_optional(Addr(0x2000)), 0);
+  S2->addByteInterval(I2);
+  std::array<int, 2> inds = {20, 21};
+  auto lib_blocks = make_code_blocks(C, I2, inds);
+  blocks.insert(lib_blocks.begin(), lib_blocks.end());
+  addFallthrough(20, 21);
+  addReturn(21, 11);
+  addBranch(5, 20); // tail call from f2 into the library
+  auto g = boost::uuids::random_generator()();
+  auto* g_sym = Symbol::Create(C, get_code_block(blocks, 20), "g");
+  M2->addSymbol(g_sym);
+  M2->addAuxData<schema::FunctionEntries>({{g, {blocks[20]->getUUID()}}});
+  M2->addAuxData<schema::FunctionBlocks>(
+      {{g, {blocks[20]->getUUID(), blocks[21]->getUUID()}}});
+  M2->addAuxData<schema::FunctionNames>({{g, g_sym->getUUID()}});
+  // And a module without functions
+  auto* M3 = Module::Create(C, "data");
+  IR->addModule(M3);
+
+  for (unsigned threads : {1u, 2u, 0u}) {
+    FunctionBuildOptions opts;
+    FunctionBuildStats stats;
+    opts.NumThreads = threads;
+    opts.ExitBlocks = ExitBlockMode::Eager;
+    opts.Stats = &stats;
+    auto result = build_functions(C, *IR, opts);
+    ASSERT_EQ(result.size(), 3);
+    EXPECT_EQ(result[0].Mod, M);
+    EXPECT_EQ(result[1].Mod, M2);
+    EXPECT_EQ(result[2].Mod, M3);
+    EXPECT_TRUE(result[2].Functions.empty());
+    EXPECT_EQ(stats.Functions, functions.size() + 1);
+    for (auto& [mod, fns] : result) {
+      auto expected = build_functions(C, *mod);
+      ASSERT_EQ(fns.size(), expected.size());
+      for (size_t i = 0; i < fns.size(); ++i) {
+        EXPECT_EQ(fns[i].getUUID(), expected[i].getUUID());
+        EXPECT_EQ(as_set(fns[i].all_blocks()),
+                  as_set(expected[i].all_blocks()));
+        EXPECT_EQ(as_set(fns[i].exit_blocks()),
+                  as_set(expected[i].exit_blocks()));
+      }
+    }
+  }
+
+  const auto& const_ir = *IR;
+  auto const_result =
+      build_functions(static_cast<const Context&>(C), const_ir);
+  static_assert(
+      std::is_same<decltype(const_result),
+                   std::vector<ModuleFunctions<const Module>>>::value);
+  EXPECT_EQ(const_result[1].Functions.size(), 1);
+}
+
+TEST_F(TestData, TEST_LOCAL_CFG) {
+  for (auto& fun : functions) {
+    if (fun.getUUID() != f3) {
+      continue;
+    }
+    const LocalCFG& cfg = fun.local_cfg();
+    EXPECT_EQ(&cfg, &fun.local_cfg());
+
+    // Blocks 6, 7, 8, 9 in address order; 8 -> 10 and 9 -> 11 leave f3
+    ASSERT_EQ(cfg.size(), 4);
+    for (LocalCFG::index_type i = 0; i < 4; ++i) {
+      EXPECT_EQ(cfg.block(i), blocks[6 + i]);
+      EXPECT_EQ(cfg.index(blocks[6 + i]), i);
+    }
+    EXPECT_FALSE(cfg.index(blocks[10]));
+    EXPECT_EQ(cfg.num_edges(), 3);
+    using Indices = std::vector<LocalCFG::index_type>;
+    auto as_vector = [](auto range) {
+      return Indices(range.begin(), range.end());
+    };
+    EXPECT_EQ(as_vector(cfg.entries()), (Indices{0, 1}));
+    EXPECT_EQ(as_vector(cfg.successors(0)), Indices{2});
+    EXPECT_EQ(as_vector(cfg.successors(2)), Indices{3});
+    EXPECT_TRUE(cfg.successors(3).empty());
+    EXPECT_EQ(as_vector(cfg.predecessors(2)), (Indices{0, 1}));
+    EXPECT_EQ(as_vector(cfg.predecessors(3)), Indices{2});
+
+    PackedEdge branch = cfg.successor_edges(2).front();
+    EXPECT_TRUE(branch.labeled());
+    EXPECT_EQ(branch.type(), EdgeType::Branch);
+    EXPECT_TRUE(branch.conditional());
+    EXPECT_TRUE(branch.direct());
+    PackedEdge fallthrough = cfg.predecessor_edges(2).front();
+    EXPECT_EQ(fallthrough.type(), EdgeType::Fallthrough);
+    EXPECT_FALSE(fallthrough.conditional());
+  }
+}
+
+TEST_F(TestData, TEST_CALL_GRAPH) {
+  // f1 calls f2 from block 1 and f3's entry 6 from block 2; f3 calls into
+  // the middle of f1, an import and an unresolved target
+  addEdge(1, 4, EdgeType::Call, ConditionalEdge::OnFalse);
+  addEdge(2, 6, EdgeType::Call, ConditionalEdge::OnFalse);
+  addEdge(9, 2, EdgeType::Call, ConditionalEdge::OnFalse);
+  addEdge(9, 11, EdgeType::Call, ConditionalEdge::OnFalse);
+  auto* unknown = ProxyBlock::Create(C);
+  blocks[12] = unknown;
+  addVertex(unknown, IR->getCFG());
+  auto edge = gtirb::addEdge(blocks[8], unknown, IR->getCFG());
+  IR->getCFG()[*edge] = EdgeLabel{std::tuple{
+      ConditionalEdge::OnFalse, DirectEdge::IsIndirect, EdgeType::Call}};
+
+  auto fns = build_functions(C, *M);
+  std::map<UUID, CallGraph<Module>::node_type> node;
+  for (size_t i = 0; i < fns.size(); ++i) {
+    node[fns[i].getUUID()] = static_cast<CallGraph<Module>::node_type>(i);
+  }
+  using Calls = std::set<std::pair<CallGraph<Module>::node_type, CodeBlock*>>;
+  auto as_set = [](auto range) {
+    Calls calls;
+    for (auto& call : range) {
+      calls.emplace(call.Node, call.Site);
+    }
+    return calls;
+  };
+  auto block = [this](int i) { return get_code_block(blocks, i); };
+
+  for (unsigned threads : {1u, 4u}) {
+    CallGraph<Module> graph(fns, threads);
+    ASSERT_EQ(graph.num_functions(), 3);
+    EXPECT_EQ(graph.num_nodes(), 5);
+    EXPECT_EQ(graph.num_calls(), 5);
+    EXPECT_FALSE(graph.is_function(graph.indirect_node()));
+
+    EXPECT_EQ(as_set(graph.callees(node[f1])),
+              (Calls{{node[f2], block(1)}, {node[f3], block(2)}}));
+    EXPECT_TRUE(graph.callees(node[f2]).empty());
+    EXPECT_EQ(as_set(graph.callees(node[f3])),
+              (Calls{{node[f1], block(9)},
+                     {graph.unresolved_node(), block(9)},
+                     {graph.indirect_node(), block(8)}}));
+
+    EXPECT_EQ(as_set(graph.callers(node[f1])), (Calls{{node[f3], block(9)}}));
+    EXPECT_EQ(as_set(graph.callers(node[f2])), (Calls{{node[f1], block(1)}}));
+    EXPECT_EQ(as_set(graph.callers(graph.indirect_node())),
+              (Calls{{node[f3], block(8)}}));
+    EXPECT_TRUE(graph.callees(graph.unresolved_node()).empty());
+  }
+}
+
+TEST_F(TestData, TEST_EDITS) {
+  auto as_set = [](auto range) {
+    return std::set<CodeBlock*>(range.begin(), range.end());
+  };
+  auto block = [this](int i) { return get_code_block(blocks, i); };
+  auto fns = build_functions(C, *M);
+  std::map<UUID, Function<Module>> by_id;
+  for (auto& fun : fns) {
+    by_id.emplace(fun.getUUID(), fun);
+  }
+  Function<const Module> const_f3 = by_id.at(f3);
+
+  // f3 loses entry 7 (and its names f4) and block 9; f2 gains block 3
+  auto& fn3 = by_id.at(f3);
+  EXPECT_TRUE(fn3.remove_entry_block(block(7)));
+  EXPECT_FALSE(fn3.remove_entry_block(block(7)));
+  EXPECT_TRUE(fn3.remove_block(block(9)));
+  EXPECT_EQ(as_set(fn3.entry_blocks()), std::set<CodeBlock*>{block(6)});
+  EXPECT_EQ(as_set(fn3.all_blocks()),
+            (std::set<CodeBlock*>{block(6), block(7), block(8)}));
+  EXPECT_EQ(fn3.getLongName(), "f3");
+  EXPECT_EQ(as_set(fn3.exit_blocks()), std::set<CodeBlock*>{block(8)});
+  // Copies made before the edits are unchanged
+  EXPECT_EQ(boost::distance(const_f3.entry_blocks()), 2);
+  EXPECT_EQ(const_f3.getLongName(), "f3 (a.k.a f4)");
+
+  auto& fn2 = by_id.at(f2);
+  EXPECT_TRUE(fn2.add_block(block(3)));
+  EXPECT_FALSE(fn2.add_block(block(3)));
+  EXPECT_TRUE(fn2.add_entry_block(block(5)));
+  EXPECT_TRUE(fn2.set_name(nullptr));
+
+  // A new function, and f1 removed
+  auto f5 = boost::uuids::random_generator()();
+  auto fn5 = Function<Module>::create(*M, f5);
+  fn5.add_entry_block(block(10));
+  auto* name5 = Symbol::Create(C, block(10), "f5");
+  M->addSymbol(name5);
+  fn5.set_name(name5);
+
+  FunctionEdits edits(*M);
+  edits.update(fn2);
+  edits.update(fn3);
+  edits.update(fn5);
+  edits.remove(f1);
+  EXPECT_EQ(edits.size(), 4);
+  edits.commit();
+  EXPECT_TRUE(edits.empty());
+
+  auto* entries = M->getAuxData<schema::FunctionEntries>();
+  auto* fn_blocks_aux = M->getAuxData<schema::FunctionBlocks>();
+  auto* names = M->getAuxData<schema::FunctionNames>();
+  EXPECT_EQ(entries->count(f1), 0);
+  EXPECT_EQ(fn_blocks_aux->count(f1), 0);
+  EXPECT_EQ(names->count(f1), 0);
+  EXPECT_EQ(names->count(f2), 0);
+  EXPECT_EQ(names->at(f5), name5->getUUID());
+  EXPECT_EQ(entries->at(f5), std::set<UUID>{blocks[10]->getUUID()});
+
+  // Rebuilding from the AuxData gives the edited functions
+  auto rebuilt = build_functions(C, *M);
+  ASSERT_EQ(rebuilt.size(), 3);
+  for (auto& fun : rebuilt) {
+    auto& edited = fun.getUUID() == f5 ? fn5 : by_id.at(fun.getUUID());
+    EXPECT_EQ(as_set(fun.entry_blocks()), as_set(edited.entry_blocks()));
+    EXPECT_EQ(as_set(fun.all_blocks()), as_set(edited.all_blocks()));
+    EXPECT_EQ(fun.getName(), edited.getName());
+  }
+}
+
+TEST_F(TestData, TEST_FUNCTION_CACHE) {
+  auto as_set = [](auto range) {
+    return std::set<CodeBlock*>(range.begin(), range.end());
+  };
+  std::string path = ::testing::TempDir() + "gtirb-functions.test.cache";
+  std::remove(path.c_str());
+  uint64_t key = FunctionCache::key(*M);
+  EXPECT_FALSE(FunctionCache::open(path, key));
+
+  // The first build writes the cache, the second reads it back
+  auto built = build_functions_cached(C, *M, path);
+  auto cache = FunctionCache::open(path, key);
+  ASSERT_TRUE(cache);
+  ASSERT_EQ(cache->size(), functions.size());
+  EXPECT_FALSE(FunctionCache::open(path, key + 1));
+
+  auto loaded = build_functions_cached(C, *M, path);
+  ASSERT_EQ(loaded.size(), functions.size());
+  for (size_t i = 0; i < loaded.size(); ++i) {
+    auto& fun = loaded[i];
+    auto& expected = functions[i];
+    EXPECT_EQ(fun.getUUID(), expected.getUUID());
+    EXPECT_EQ(cache->uuid(i), expected.getUUID());
+    EXPECT_EQ(as_set(fun.entry_blocks()), as_set(expected.entry_blocks()));
+    EXPECT_EQ(as_set(fun.all_blocks()), as_set(expected.all_blocks()));
+    EXPECT_EQ(as_set(fun.exit_blocks()), as_set(expected.exit_blocks()));
+    EXPECT_EQ(fun.getName(), expected.getName());
+    EXPECT_EQ(fun.getLongName(), expected.getLongName());
+    EXPECT_EQ(cache->long_name(i), expected.getLongName());
+    EXPECT_EQ(boost::distance(cache->all_blocks(i)),
+              boost::distance(expected.all_blocks()));
+    EXPECT_EQ(cache->exit_kinds(i).size(),
+              expected.tagged_exit_blocks().size());
+  }
+
+  // Editing the function AuxData invalidates the cache
+  fn_blocks[f2].insert(blocks[3]->getUUID());
+  writeAuxData();
+  EXPECT_NE(FunctionCache::key(*M), key);
+  EXPECT_FALSE(FunctionCache::open(path, FunctionCache::key(*M)));
+  for (auto& fun : build_functions_cached(C, *M, path)) {
+    if (fun.getUUID() == f2) {
+      EXPECT_EQ(boost::distance(fun.all_blocks()), 3);
+    }
+  }
+  EXPECT_TRUE(FunctionCache::open(path, FunctionCache::key(*M)));
+
+  // So does editing the CFG, which exit blocks come from, or the symbols,
+  // which names come from
+  key = FunctionCache::key(*M);
+  addBranch(3, 9);
+  EXPECT_NE(FunctionCache::key(*M), key);
+  key = FunctionCache::key(*M);
+  M->addSymbol(Symbol::Create(C, get_code_block(blocks, 7), "f4_alias"));
+  EXPECT_NE(FunctionCache::key(*M), key);
+  key = FunctionCache::key(*M);
+  EXPECT_EQ(FunctionCache::key(*M, 1), FunctionCache::key(*M, 1));
+  EXPECT_NE(FunctionCache::key(*M, 1), key);
+  std::remove(path.c_str());
+}
+
+TEST_F(TestData, TEST_STREAM) {
+  // Aliases, so that long names list several of them
+  const CodeBlock* entry = *functions.front().entry_blocks().begin();
+  for (const char* alias : {"zz_alias", "mm_alias", "aa_alias"}) {
+    M->addSymbol(Symbol::Create(C, const_cast<CodeBlock*>(entry), alias));
+  }
+  // Both an indirect and a direct jump to a proxy block
+  addIndirectBranch(1, 11);
+  addBranch(8, 11);
+  functions = build_functions(C, *M);
+  const std::string& long_name = functions.front().getLongName();
+  EXPECT_LT(long_name.find("aa_alias"), long_name.find("mm_alias"));
+  EXPECT_LT(long_name.find("mm_alias"), long_name.find("zz_alias"));
+  std::stringstream file;
+  IR->save(file);
+  auto mods = read_functions(file);
+  ASSERT_TRUE(mods);
+  ASSERT_EQ(mods->size(), 1);
+  const StreamedModule& mod = mods->front();
+  EXPECT_EQ(mod.Name, "example");
+  EXPECT_EQ(mod.Blocks.size(), boost::distance(interval->code_blocks()));
+  EXPECT_EQ(mod.Blocks.back().Address, 0x100b);
+
+  auto uuids = [&mod](const std::vector<uint32_t>& indices) {
+    std::set<UUID> ids;
+    for (uint32_t i : indices) {
+      ids.insert(mod.Blocks[i].Uuid);
+    }
+    return ids;
+  };
+  auto block_uuids = [](auto range) {
+    std::set<UUID> ids;
+    for (const auto* block : range) {
+      ids.insert(block->getUUID());
+    }
+    return ids;
+  };
+  ASSERT_EQ(mod.Functions.size(), functions.size());
+  for (size_t i = 0; i < functions.size(); ++i) {
+    const StreamedFunction& fun = mod.Functions[i];
+    auto& expected = functions[i];
+    EXPECT_EQ(fun.Uuid, expected.getUUID());
+    EXPECT_EQ(uuids(fun.EntryBlocks), block_uuids(expected.entry_blocks()));
+    EXPECT_EQ(uuids(fun.AllBlocks), block_uuids(expected.all_blocks()));
+    EXPECT_EQ(fun.Name, std::string(expected.getName()->getName()));
+    EXPECT_EQ(fun.Names.size(), boost::distance(expected.name_symbols()));
+    EXPECT_EQ(fun.LongName, expected.getLongName());
+    std::map<UUID, uint8_t> exits, expected_exits;
+    for (const auto& exit : fun.ExitBlocks) {
+      exits[mod.Blocks[exit.Block].Uuid] = exit.Kinds;
+    }
+    for (const auto& exit : expected.tagged_exit_blocks()) {
+      expected_exits[exit.Block->getUUID()] = exit.Kinds;
+    }
+    EXPECT_EQ(exits, expected_exits);
+  }
+  std::map<UUID, uint8_t> proxy_exits;
+  for (const auto& fun : mod.Functions) {
+    for (const auto& exit : fun.ExitBlocks) {
+      proxy_exits[mod.Blocks[exit.Block].Uuid] |= exit.Kinds;
+    }
+  }
+  EXPECT_TRUE(proxy_exits[blocks[1]->getUUID()] &
+              static_cast<uint8_t>(ExitKind::Unresolved));
+  EXPECT_TRUE(proxy_exits[blocks[8]->getUUID()] &
+              static_cast<uint8_t>(ExitKind::TailCall));
+
+  // Without the CFG, there are no exits
+  file.clear();
+  file.seekg(0);
+  auto no_exits = read_functions(file, false);
+  ASSERT_TRUE(no_exits);
+  for (const auto& fun : no_exits->front().Functions) {
+    EXPECT_TRUE(fun.ExitBlocks.empty());
+  }
+
+  // Truncated input is rejected
+  std::string bytes = file.str();
+  std::stringstream truncated(bytes.substr(0, bytes.size() / 2));
+  EXPECT_FALSE(read_functions(truncated));
+}
+
+TEST_F(TestData, TEST_BLOCK_MEMBERSHIP) {
+  // f5 shares block 2 with f1
+  auto f5 = make_function("f5", {2}, {2, 3});
+  writeAuxData();
+  auto fns = build_functions(C, *M);
+  BlockMembership<Module> membership(fns, 2);
+  const BlockNumbering& numbering = membership.numbering();
+  ASSERT_EQ(numbering.size(), 10);
+  for (BlockNumbering::index_type i = 1; i < numbering.size(); ++i) {
+    EXPECT_LT(*numbering.block(i - 1)->getAddress(),
+              *numbering.block(i)->getAddress());
+  }
+  EXPECT_EQ(numbering.index(blocks[11]), std::nullopt);
+
+  size_t i1 = 0, i5 = 0;
+  for (size_t i = 0; i < fns.size(); ++i) {
+    EXPECT_EQ(membership.blocks(i).count(),
+              boost::distance(fns[i].all_blocks()));
+    for (auto* block : fns[i].all_blocks()) {
+      EXPECT_TRUE(membership.contains(i, block));
+      EXPECT_TRUE(membership.contains_index(i, *numbering.index(block)));
+    }
+    i1 = fns[i].getUUID() == f1 ? i : i1;
+    i5 = fns[i].getUUID() == f5 ? i : i5;
+  }
+  EXPECT_FALSE(membership.contains(i1, blocks[4]));
+  EXPECT_TRUE(membership.in_any_function(blocks[3]));
+  EXPECT_FALSE(membership.in_any_function(blocks[11]));
+  ASSERT_TRUE(numbering.index(blocks[4]));
+  EXPECT_FALSE(membership.contains_index(i1, *numbering.index(blocks[4])));
+  for (BlockNumbering::index_type i = 0; i < numbering.size(); ++i) {
+    EXPECT_TRUE(membership.index_in_any_function(i));
+  }
+  EXPECT_EQ(membership.covered().count(), 10);
+
+  auto shared = membership.shared().indices();
+  ASSERT_EQ(shared.size(), 1);
+  EXPECT_EQ(numbering.block(shared[0]), blocks[2]);
+  auto overlaps = membership.overlaps();
+  ASSERT_EQ(overlaps.size(), 1);
+  EXPECT_EQ(overlaps[0].First, std::min(i1, i5));
+  EXPECT_EQ(overlaps[0].Second, std::max(i1, i5));
+  EXPECT_EQ(overlaps[0].Shared, 1);
+
+  // Set operations across windows that only partly overlap
+  BlockBitset a(std::vector<uint32_t>{3, 70, 200});
+  BlockBitset b(std::vector<uint32_t>{70, 130, 200, 500});
+  EXPECT_EQ(a.num_words(), 4);
+  EXPECT_TRUE(a.intersects(b));
+  EXPECT_EQ(a.intersection_count(b), 2);
+  EXPECT_EQ((a & b).indices(), (std::vector<uint32_t>{70, 200}));
+  EXPECT_EQ((a & b).first_word(), 1);
+  EXPECT_EQ((a | b).indices(),
+            (std::vector<uint32_t>{3, 70, 130, 200, 500}));
+  EXPECT_FALSE(a.intersects(BlockBitset(std::vector<uint32_t>{1000})));
+  EXPECT_TRUE((a & BlockBitset(std::vector<uint32_t>{1000})).empty());
+  EXPECT_EQ(BlockBitset::shared({a, b}), a & b);
+}
+
+TEST_F(TestData, TEST_BLOCKS_BY_ADDRESS) {
+  for (auto& fun : functions) {
+    auto range = fun.blocks_by_address();
+    ASSERT_EQ(boost::distance(range), boost::distance(fun.all_blocks()));
+    std::optional<Addr> previous;
+    for (const auto& entry : range) {
+      EXPECT_TRUE(fun.all_blocks_end() !=
+                  std::find(fun.all_blocks_begin(), fun.all_blocks_end(),
+                            entry.Block));
+      EXPECT_EQ(entry.Address, entry.Block->getAddress());
+      EXPECT_EQ(entry.Size, entry.Block->getSize());
+      if (previous) {
+        EXPECT_LT(*previous, *entry.Address);
+      }
+      previous = entry.Address;
+    }
+    // Cached and shared between copies
+    Function<const Module> copy = fun;
+    EXPECT_EQ(copy.blocks_by_address().begin(), range.begin().base());
+  }
+
+  // Edits drop the cached order
+  auto fun = functions[0];
+  auto* extra = get_code_block(blocks, 10);
+  fun.add_block(extra);
+  auto range = fun.blocks_by_address();
+  ASSERT_EQ(boost::distance(range), boost::distance(fun.all_blocks()));
+  EXPECT_EQ((range.end() - 1)->Block, extra);
+}
+
+TEST_F(TestData, TEST_BUILD_STATS) {
+  FunctionBuildStats stats;
+  FunctionBuildOptions opts;
+  opts.ExitBlocks = ExitBlockMode::Eager;
+  opts.Stats = &stats;
+  auto fns = build_functions(C, *M, opts);
+  ASSERT_EQ(fns.size(), 3);
+  EXPECT_EQ(stats.Functions, 3);
+  // Entries, blocks and names
+  EXPECT_EQ(stats.ResolvedReferences, 5 + 9 + 3);
+  EXPECT_EQ(stats.DanglingReferences, 0);
+  EXPECT_EQ(stats.FunctionsWithoutBlocks, 0);
+  EXPECT_EQ(stats.FunctionsWithoutNames, 0);
+  EXPECT_GT(stats.ResultBytes, 0);
+  EXPECT_GT(stats.PeakBytes, stats.ResultBytes);
+  EXPECT_GE(stats.TotalTime, stats.ResolveTime + stats.SymbolTime);
+  EXPECT_GE(stats.TotalTime, stats.ExitTime);
+
+  size_t metrics = 0;
+  stats.for_each([&](std::string_view name, uint64_t value) {
+    ++metrics;
+    if (name == "functions") {
+      EXPECT_EQ(value, 3);
+    }
+  });
+  EXPECT_EQ(metrics, 13);
+
+  // Dangling references, and a function with neither blocks nor names
+  auto missing = boost::uuids::random_generator()();
+  fn_blocks[f2].insert(missing);
+  fn_entries[f3].insert(missing);
+  fn_names[f1] = blocks[0]->getUUID();
+  auto f4 = boost::uuids::random_generator()();
+  fn_entries[f4].insert(boost::uuids::random_generator()());
+  writeAuxData();
+
+  stats = FunctionBuildStats();
+  fns = build_functions(C, *M, opts);
+  ASSERT_EQ(fns.size(), 4);
+  EXPECT_EQ(stats.Functions, 4);
+  EXPECT_EQ(stats.ResolvedReferences, 5 + 9 + 2);
+  EXPECT_EQ(stats.DanglingReferences, 4);
+  EXPECT_EQ(stats.FunctionsWithoutBlocks, 1);
+  // f1 is still named by the symbol on its entry block
+  EXPECT_EQ(stats.FunctionsWithoutNames, 1);
+
+  // Stats add up across builds, including builds of a whole IR
+  FunctionBuildStats twice = stats;
+  twice += stats;
+  build_functions(C, *IR, opts);
+  EXPECT_EQ(stats.Functions, twice.Functions);
+  EXPECT_EQ(stats.DanglingReferences, twice.DanglingReferences);
+  EXPECT_EQ(stats.ResultBytes, twice.ResultBytes);
+
+  // Without stats, nothing is recorded
+  opts.Stats = nullptr;
+  build_functions(C, *M, opts);
+  EXPECT_EQ(stats.Functions, 8);
+}
+
+TEST_F(TestData, TEST_LAZY_EXITS_CONCURRENT) {
+  std::vector<Function<Module>> fns = build_functions(C, *M);
+  for (auto& fun : fns) {
+    // Copies share the lazily computed exit blocks
+    std::vector<Function<Module>> copies(8, fun);
+    std::vector<std::thread> threads;
+    std::vector<std::set<CodeBlock*>> results(copies.size());
+    for (size_t i = 0; i < copies.size(); ++i) {
+      threads.emplace_back([&, i]() {
+        auto exits = copies[i].exit_blocks();
+        results[i].insert(exits.begin(), exits.end());
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (auto& result : results) {
+      EXPECT_EQ(result, results[0]);
+    }
+    EXPECT_FALSE(results[0].empty());
+  }
+
+  // Exits computed before a const conversion are carried over
+  Function<const Module> converted = fns[0];
+  EXPECT_EQ(std::distance(converted.exit_blocks_begin(),
+                          converted.exit_blocks_end()),
+            std::distance(fns[0].exit_blocks_begin(),
+                          fns[0].exit_blocks_end()));
+}
+
+TEST_F(TestData, TEST_FUNCTION_INDEX) {
+  // f5 shares block 2 with f1
+  auto f5 = make_function("f5", {10}, {10, 2});
+  writeAuxData();
+  const auto fns = build_functions(C, *M);
+  FunctionIndex<Module> index(fns);
+
+  auto owners = [&](auto range) {
+    std::set<UUID> ids;
+    for (size_t i : range) {
+      ids.insert(fns[i].getUUID());
+    }
+    return ids;
+  };
+
+  auto* b2 = get_code_block(blocks, 2);
+  EXPECT_EQ(owners(index.functions(b2)), (std::set<UUID>{f1, f5}));
+  EXPECT_EQ(owners(index.functions(b2->getUUID())), (std::set<UUID>{f1, f5}));
+  EXPECT_EQ(owners(index.functions(get_code_block(blocks, 4))),
+            (std::set<UUID>{f2}));
+  // Block 3 is not part of any function
+  EXPECT_TRUE(index.functions(get_code_block(blocks, 3)).empty());
+
+  // Block i lives at 0x1000 + i + 1 with size 1
+  EXPECT_EQ(owners(index.functions_at(Addr(0x1001))), (std::set<UUID>{f1}));
+  EXPECT_EQ(owners(index.functions_at(Addr(0x1003))),
+            (std::set<UUID>{f1, f5}));
+  EXPECT_TRUE(index.functions_at(Addr(0x1004)).empty());
+  EXPECT_TRUE(index.functions_at(Addr(0x0fff)).empty());
+  EXPECT_TRUE(index.functions_at(Addr(0x2000)).empty());
+  EXPECT_EQ(owners(index.functions_at(Addr(0x100b))), (std::set<UUID>{f5}));
+
+  auto in_range = index.functions_in(Addr(0x1003), Addr(0x1008));
+  EXPECT_TRUE(std::is_sorted(in_range.begin(), in_range.end()));
+  EXPECT_EQ(owners(in_range), (std::set<UUID>{f1, f2, f5, f3}));
+  EXPECT_TRUE(index.functions_in(Addr(0x1004), Addr(0x1005)).empty());
+  EXPECT_TRUE(index.functions_in(Addr(0x1003), Addr(0x1003)).empty());
+}
+
+TEST_F(TestData, TEST_FUNCTION_TABLE) {
+  auto as_set = [](auto range) {
+    return std::set<const CodeBlock*>(range.begin(), range.end());
+  };
+  const auto& const_fns = functions;
+  FunctionTable<Module> table(const_fns);
+  ASSERT_EQ(table.size(), functions.size());
+  // Built straight from the AuxData, in the same order
+  FunctionTable<Module> direct(C, *M);
+  ASSERT_EQ(direct.size(), functions.size());
+
+  size_t i = 0;
+  for (const auto& entry : table) {
+    const auto& from_aux = direct[i];
+    auto& fun = functions[i++];
+    EXPECT_EQ(from_aux.getUUID(), fun.getUUID());
+    EXPECT_EQ(from_aux.getName(), fun.getName());
+    EXPECT_EQ(as_set(from_aux.entry_blocks()), as_set(fun.entry_blocks()));
+    EXPECT_EQ(as_set(from_aux.exit_blocks()), as_set(fun.exit_blocks()));
+    EXPECT_EQ(as_set(from_aux.all_blocks()), as_set(fun.all_blocks()));
+    EXPECT_TRUE(std::equal(from_aux.name_symbols_begin(),
+                           from_aux.name_symbols_end(),
+                           entry.name_symbols_begin(),
+                           entry.name_symbols_end()));
+    EXPECT_EQ(entry.getUUID(), fun.getUUID());
+    EXPECT_EQ(entry.getName(), fun.getName());
+    EXPECT_EQ(as_set(entry.entry_blocks()), as_set(fun.entry_blocks()));
+    EXPECT_EQ(as_set(entry.exit_blocks()), as_set(fun.exit_blocks()));
+    EXPECT_EQ(as_set(entry.all_blocks()), as_set(fun.all_blocks()));
+    EXPECT_EQ(std::set<const Symbol*>(entry.name_symbols_begin(),
+                                      entry.name_symbols_end()),
+              std::set<const Symbol*>(fun.name_symbols_begin(),
+                                      fun.name_symbols_end()));
+    for (auto* block : fun.all_blocks()) {
+      EXPECT_TRUE(entry.contains(block));
+    }
+    for (auto* block : fun.exit_blocks()) {
+      EXPECT_TRUE(entry.is_exit(block));
+    }
+    for (auto* block : fun.entry_blocks()) {
+      EXPECT_TRUE(entry.is_entry(block));
+    }
+    EXPECT_FALSE(entry.contains(get_code_block(blocks, 3)));
+  }
+
+  // The table stays valid when moved, and can be built for const modules
+  FunctionTable<Module> moved = std::move(table);
+  EXPECT_TRUE(moved[0].contains(*functions[0].all_blocks_begin()));
+  const Module& M2 = *M;
+  auto const_functions = build_functions(C, M2);
+  FunctionTable<const Module> const_table(const_functions);
+  EXPECT_EQ(const_table.size(), const_functions.size());
+
+  // Exits are left out on request
+  FunctionBuildOptions opts;
+  opts.ExitBlocks = ExitBlockMode::Skip;
+  FunctionTable<const Module> no_exits(C, M2, opts);
+  ASSERT_EQ(no_exits.size(), functions.size());
+  for (const auto& entry : no_exits) {
+    EXPECT_TRUE(entry.exit_blocks().empty());
+  }
+}
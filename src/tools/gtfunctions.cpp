@@ -0,0 +1,207 @@
+//===- gtfunctions.cpp ------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2021 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// Lists the functions of a GTIRB file, like `python3 -m gtirb_functions`.
+//
+// With --stream, the file is never loaded: only the parts needed to list the
+// functions are read from it, see read_functions().
+//
+//===----------------------------------------------------------------------===//
+#include "gtirb_functions/function_stream.hpp"
+#include "gtirb_functions/gtirb_functions.hpp"
+#include <gtirb/gtirb.hpp>
+#include <boost/uuid/uuid_io.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+using namespace gtirb;
+
+namespace {
+
+/// \brief A block, as printed
+struct BlockRef {
+  std::optional<uint64_t> Address;
+  UUID Uuid;
+
+  bool operator<(const BlockRef& Other) const {
+    if (Address.has_value() != Other.Address.has_value()) {
+      return Address.has_value();
+    }
+    return std::tie(Address, Uuid) < std::tie(Other.Address, Other.Uuid);
+  }
+};
+
+/// \brief A function, as printed
+struct FunctionRow {
+  UUID Uuid;
+  std::string Name;
+  std::vector<BlockRef> Entries;
+  std::vector<BlockRef> Exits;
+  std::vector<BlockRef> Blocks;
+};
+
+std::ostream& operator<<(std::ostream& Out, const std::vector<BlockRef>& Refs) {
+  Out << '[';
+  for (size_t I = 0; I < Refs.size(); ++I) {
+    if (I != 0) {
+      Out << ", ";
+    }
+    if (Refs[I].Address) {
+      Out << "0x" << std::hex << *Refs[I].Address << std::dec;
+    } else {
+      Out << Refs[I].Uuid;
+    }
+  }
+  return Out << ']';
+}
+
+void printModule(const std::string& Name, std::vector<FunctionRow>& Rows) {
+  if (Rows.empty()) {
+    return;
+  }
+  std::sort(Rows.begin(), Rows.end(),
+            [](const auto& A, const auto& B) { return A.Name < B.Name; });
+  std::cout << "Module: " << Name << '\n';
+  for (auto& Row : Rows) {
+    std::sort(Row.Entries.begin(), Row.Entries.end());
+    std::sort(Row.Exits.begin(), Row.Exits.end());
+    std::sort(Row.Blocks.begin(), Row.Blocks.end());
+    std::cout << "\tFunction: " << Row.Name << '\n'
+              << "[UUID=" << Row.Uuid << ", Name=" << Row.Name
+              << ", Entry=" << Row.Entries << ", Exit=" << Row.Exits
+              << ", All=" << Row.Blocks << "]\n";
+  }
+}
+
+template <class RangeType> std::vector<BlockRef> blockRefs(RangeType Blocks) {
+  std::vector<BlockRef> Refs;
+  for (const CodeBlock* Block : Blocks) {
+    std::optional<uint64_t> Address;
+    if (auto A = Block->getAddress()) {
+      Address = static_cast<uint64_t>(*A);
+    }
+    Refs.push_back({Address, Block->getUUID()});
+  }
+  return Refs;
+}
+
+int listLoaded(std::istream& In, bool Exits, bool Stats) {
+  Context C;
+  auto Ir = IR::load(C, In);
+  if (!Ir) {
+    std::cerr << "error: could not load the IR\n";
+    return 1;
+  }
+  FunctionBuildOptions Opts;
+  Opts.NumThreads = 0;
+  Opts.ExitBlocks = Exits ? ExitBlockMode::Eager : ExitBlockMode::Skip;
+  FunctionBuildStats BuildStats;
+  if (Stats) {
+    Opts.Stats = &BuildStats;
+  }
+  for (auto& [Mod, Fns] : build_functions(C, **Ir, Opts)) {
+    std::vector<FunctionRow> Rows;
+    for (auto& Fn : Fns) {
+      Rows.push_back({Fn.getUUID(), Fn.getLongName(),
+                      blockRefs(Fn.entry_blocks()),
+                      blockRefs(Fn.exit_blocks()), blockRefs(Fn.all_blocks())});
+    }
+    printModule(Mod->getName(), Rows);
+  }
+  if (Stats) {
+    BuildStats.for_each([](std::string_view Name, uint64_t Value) {
+      std::cerr << Name << ' ' << Value << '\n';
+    });
+  }
+  return 0;
+}
+
+int listStreamed(std::istream& In, bool Exits) {
+  auto Mods = read_functions(In, Exits);
+  if (!Mods) {
+    std::cerr << "error: not a well-formed GTIRB file\n";
+    return 1;
+  }
+  for (auto& Mod : *Mods) {
+    auto refs = [&Mod](const auto& Indices) {
+      std::vector<BlockRef> Refs;
+      for (uint32_t I : Indices) {
+        Refs.push_back({Mod.Blocks[I].Address, Mod.Blocks[I].Uuid});
+      }
+      return Refs;
+    };
+    std::vector<FunctionRow> Rows;
+    for (auto& Fn : Mod.Functions) {
+      std::vector<uint32_t> ExitIndices;
+      for (const auto& Exit : Fn.ExitBlocks) {
+        ExitIndices.push_back(Exit.Block);
+      }
+      Rows.push_back({Fn.Uuid, std::move(Fn.LongName), refs(Fn.EntryBlocks),
+                      refs(ExitIndices), refs(Fn.AllBlocks)});
+    }
+    printModule(Mod.Name, Rows);
+  }
+  return 0;
+}
+
+} // namespace
+
+int main(int Argc, char** Argv) {
+  bool Stream = false;
+  bool Exits = true;
+  bool Stats = false;
+  const char* Path = nullptr;
+  for (int I = 1; I < Argc; ++I) {
+    if (!std::strcmp(Argv[I], "--stream")) {
+      Stream = true;
+    } else if (!std::strcmp(Argv[I], "--no-exits")) {
+      Exits = false;
+    } else if (!std::strcmp(Argv[I], "--stats")) {
+      Stats = true;
+    } else if (Argv[I][0] != '-' && !Path) {
+      Path = Argv[I];
+    } else {
+      Path = nullptr;
+      break;
+    }
+  }
+  if (!Path || (Stream && Stats)) {
+    std::cerr << "usage: " << Argv[0]
+              << " [--stream | --stats] [--no-exits] FILE\n"
+              << "\n"
+              << "  --stream    read only the parts of FILE needed to list "
+                 "functions,\n"
+              << "              instead of loading the whole IR\n"
+              << "  --stats     print build statistics to stderr, one "
+                 "`name value`\n"
+              << "              pair per line\n"
+              << "  --no-exits  do not compute exit blocks\n";
+    return 2;
+  }
+  std::ifstream In(Path, std::ios::in | std::ios::binary);
+  if (!In) {
+    std::cerr << "error: cannot open " << Path << '\n';
+    return 1;
+  }
+  return Stream ? listStreamed(In, Exits) : listLoaded(In, Exits, Stats);
+}
@@ -1,12 +1,22 @@
+import contextlib
+import csv
+import io
+import json
+import os
+import tempfile
 import unittest
 import uuid
 
 import gtirb
 
 import gtirb_functions
+from gtirb_functions import __main__ as cli
 
 
-class FunctionTest(unittest.TestCase):
+class ModuleBuilder:
+    """Builds the module shared by the test cases. Mixed into a
+    unittest.TestCase."""
+
     def _generate_subgraph(self, interval, *edges):
         blocks = {}
         for src, dst, *label_args in edges:
@@ -24,7 +34,7 @@ class FunctionTest(unittest.TestCase):
 
         return sorted(blocks.values(), key=lambda b: b.offset)
 
-    def test_build_functions(self):
+    def _build_module(self):
         ir = gtirb.IR()
         module = gtirb.Module(name="test")
         module.ir = ir
@@ -53,6 +63,7 @@ class FunctionTest(unittest.TestCase):
         f2_name.module = module
         f2_alt_name = gtirb.Symbol(name="f2.localalias", payload=f2_blocks[0])
         f2_alt_name.module = module
+        f2_names = (f2_name, f2_alt_name)
 
         module.aux_data["functionBlocks"] = gtirb.AuxData(
             type_name="mapping<UUID,set<UUID>>",
@@ -68,6 +79,24 @@ class FunctionTest(unittest.TestCase):
             type_name="mapping<UUID,UUID>", data={f1: f1_name, f2: f2_name},
         )
 
+        return module, (f1, f1_blocks, f1_name), (f2, f2_blocks, f2_names)
+
+    def _save_module(self, module):
+        """Save the IR of module to a temporary file, removed after the
+        test, and return its path."""
+
+        fd, path = tempfile.mkstemp(suffix=".gtirb")
+        os.close(fd)
+        self.addCleanup(os.remove, path)
+        module.ir.save_protobuf(path)
+        return path
+
+
+class FunctionTest(ModuleBuilder, unittest.TestCase):
+    def test_build_functions(self):
+        module, (f1, f1_blocks, f1_name), f2_info = self._build_module()
+        f2, f2_blocks, (f2_name, f2_alt_name) = f2_info
+
         matches = 0
         for fun in gtirb_functions.Function.build_functions(module):
             if fun.get_name() == "f1":
@@ -89,3 +118,172 @@ class FunctionTest(unittest.TestCase):
                 self.assertEqual(fun.get_all_blocks(), set(f2_blocks[:-1]))
                 matches += 1
         self.assertEqual(matches, 2)
+
+    def test_build_functions_compute_exits(self):
+        module, (f1, f1_blocks, _), (f2, f2_blocks, _) = self._build_module()
+
+        # A call out of f1 is not an exit, a branch from f2 into f1 is one
+        call = gtirb.Edge(
+            f1_blocks[1], f2_blocks[0], gtirb.Edge.Label(gtirb.Edge.Type.Call)
+        )
+        branch = gtirb.Edge(
+            f2_blocks[0],
+            f1_blocks[2],
+            gtirb.Edge.Label(gtirb.Edge.Type.Branch, True),
+        )
+        module.ir.cfg.update((call, branch))
+
+        lazy = {
+            fun.uuid: fun.get_exit_blocks()
+            for fun in gtirb_functions.Function.build_functions(module)
+        }
+        functions = gtirb_functions.Function.build_functions(
+            module, compute_exits=True
+        )
+        self.assertEqual(len(functions), 2)
+        for fun in functions:
+            # Exits are known without walking the function's edges
+            self.assertIsNotNone(fun._exit_blocks)
+            self.assertEqual(fun.get_exit_blocks(), lazy[fun.uuid])
+        exits = {fun.uuid: fun.get_exit_blocks() for fun in functions}
+        self.assertEqual(exits[f1], {f1_blocks[-2]})
+        self.assertEqual(exits[f2], {f2_blocks[0]})
+
+    def test_module_records(self):
+        module, (f1, f1_blocks, _), (f2, f2_blocks, _) = self._build_module()
+
+        record = gtirb_functions.module_records(module)
+        self.assertEqual(record.name, "test")
+        # Function blocks, numbered in address order
+        table = f1_blocks[:-1] + f2_blocks[:-1]
+        self.assertEqual(record.block_uuids, [b.uuid for b in table])
+        self.assertEqual(
+            record.block_addresses, [0x1000, 0x1001, 0x1002, 0x100A]
+        )
+        self.assertEqual(record.block_sizes, [1, 1, 1, 1])
+
+        # Functions, in UUID order
+        uuids = [fn.uuid for fn in record.functions]
+        self.assertEqual(uuids, sorted([f1, f2]))
+        functions = {fn.uuid: fn for fn in record.functions}
+        self.assertEqual(functions[f1].name, "f1")
+        self.assertEqual(functions[f1].entry_blocks, (0,))
+        self.assertEqual(functions[f1].exit_blocks, (2,))
+        self.assertEqual(functions[f1].blocks, (0, 1, 2))
+        self.assertEqual(functions[f2].names, ("f2", "f2.localalias"))
+        self.assertEqual(functions[f2].exit_blocks, (3,))
+        self.assertEqual(functions[f2].blocks, (3,))
+
+        record = gtirb_functions.module_records(module, compute_exits=False)
+        self.assertEqual([fn.exit_blocks for fn in record.functions], [(), ()])
+
+    @unittest.skipUnless(
+        gtirb_functions.HAVE_NATIVE, "the native extension is not built"
+    )
+    def test_native_records(self):
+        module, _, _ = self._build_module()
+        path = self._save_module(module)
+
+        for compute_exits in (True, False):
+            native = gtirb_functions.load_function_records(
+                path, compute_exits
+            )
+            expected = gtirb_functions.module_records(module, compute_exits)
+            self.assertEqual(native, [expected])
+
+
+class SummaryTest(ModuleBuilder, unittest.TestCase):
+    """The summary formats of the command-line tool."""
+
+    def setUp(self):
+        self.module, (f1, _, _), (f2, _, _) = self._build_module()
+        self.f1 = str(f1)
+        self.f2 = str(f2)
+        self.path = self._save_module(self.module)
+
+    def _rows(self, compute_exits=True):
+        return {
+            row[3]: row for row in cli.summarize(self.path, compute_exits)
+        }
+
+    def test_address_range(self):
+        record = gtirb_functions.module_records(self.module)
+        ranges = {
+            str(fn.uuid): cli.address_range(record, fn.blocks)
+            for fn in record.functions
+        }
+        self.assertEqual(ranges[self.f1], (0x1000, 0x1003))
+        self.assertEqual(ranges[self.f2], (0x100A, 0x100B))
+        self.assertEqual(cli.address_range(record, ()), (None, None))
+
+    def test_summarize(self):
+        rows = self._rows()
+        self.assertEqual(set(rows), {self.f1, self.f2})
+        self.assertEqual(
+            rows[self.f1],
+            [self.path, "test", "f1", self.f1, 1, 1, 3, 0x1000, 0x1003],
+        )
+        self.assertEqual(
+            rows[self.f2],
+            [self.path, "test", "f2", self.f2, 1, 1, 1, 0x100A, 0x100B],
+        )
+        # Without exits, the exit count is unknown rather than zero
+        for row in self._rows(compute_exits=False).values():
+            self.assertIsNone(row[5])
+
+    def test_format_ndjson(self):
+        for compute_exits in (True, False):
+            rows = self._rows(compute_exits)
+            text = cli.format_rows(list(rows.values()), "ndjson")
+            lines = text.splitlines()
+            self.assertEqual(len(lines), 2)
+            for line in lines:
+                obj = json.loads(line)
+                self.assertEqual(list(obj), cli.SUMMARY_FIELDS)
+                self.assertEqual(list(obj.values()), rows[obj["uuid"]])
+                if not compute_exits:
+                    self.assertIsNone(obj["exit_blocks"])
+
+    def test_format_csv(self):
+        for compute_exits in (True, False):
+            rows = self._rows(compute_exits)
+            text = cli.format_rows(list(rows.values()), "csv")
+            parsed = list(csv.reader(io.StringIO(text)))
+            self.assertEqual(len(parsed), 2)
+            for fields in parsed:
+                expected = rows[fields[3]]
+                # CSV has no None, which is written as an empty field
+                self.assertEqual(
+                    fields, ["" if v is None else str(v) for v in expected]
+                )
+                if not compute_exits:
+                    self.assertEqual(fields[5], "")
+
+    def _run_batch(self, paths, output_format, jobs):
+        out = io.StringIO()
+        with contextlib.redirect_stdout(out), self.assertLogs(
+            "gtirb.functions", "ERROR"
+        ) as logs:
+            failures = cli.run_batch(paths, True, output_format, jobs)
+        return failures, out.getvalue(), logs.output
+
+    def test_run_batch(self):
+        missing = self.path + ".missing"
+        paths = [self.path, missing, self.path]
+        for jobs in (1, 2):
+            failures, text, errors = self._run_batch(paths, "csv", jobs)
+            self.assertEqual(failures, 1)
+            self.assertEqual(len(errors), 1)
+            self.assertIn(missing, errors[0])
+
+            parsed = list(csv.reader(io.StringIO(text)))
+            self.assertEqual(parsed[0], cli.SUMMARY_FIELDS)
+            # Each good file gives its rows, in the order of the files
+            self.assertEqual(len(parsed), 1 + 2 * 2)
+            self.assertEqual(parsed[1:3], parsed[3:5])
+            self.assertEqual({row[0] for row in parsed[1:]}, {self.path})
+
+            failures, text, _ = self._run_batch(paths, "ndjson", jobs)
+            self.assertEqual(failures, 1)
+            files = [json.loads(line)["file"] for line in text.splitlines()]
+            self.assertEqual(files, [self.path] * 4)